@@ -67,6 +67,28 @@ void assoc_init(const int hashtable_init) {
     STATS_UNLOCK();
 }
 
+/* Key equality without the libc memcmp call. Keys are short (session ids,
+ * tokens) so the length dispatch and PLT hop in memcmp cost more than the
+ * compare itself; eight bytes at a time plus a byte tail covers the common
+ * fixed-length keys in two or three word compares. */
+static inline bool key_eq(const char *a, const char *b, size_t n) {
+    while (n >= 8) {
+        uint64_t wa, wb;
+        memcpy(&wa, a, 8);
+        memcpy(&wb, b, 8);
+        if (wa != wb)
+            return false;
+        a += 8;
+        b += 8;
+        n -= 8;
+    }
+    while (n--) {
+        if (*a++ != *b++)
+            return false;
+    }
+    return true;
+}
+
 item *assoc_find(const char *key, const size_t nkey, const uint32_t hv) {
     item *it;
     uint64_t oldbucket;
@@ -84,7 +106,10 @@ item *assoc_find(const char *key, const size_t nkey, const uint32_t hv) {
     int depth = 0;
 #endif
     while (it) {
-        if ((nkey == it->nkey) && (memcmp(key, ITEM_key(it), nkey) == 0)) {
+        /* start pulling the next chain entry while we compare this one, so
+         * a collision costs overlapping fetches instead of serial ones */
+        __builtin_prefetch(it->h_next, 0, 1);
+        if ((nkey == it->nkey) && key_eq(key, ITEM_key(it), nkey)) {
             ret = it;
             break;
         }
@@ -97,6 +122,21 @@ item *assoc_find(const char *key, const size_t nkey, const uint32_t hv) {
     return ret;
 }
 
+/* Pull the bucket slot for hv towards the cache ahead of a lookup. This is
+ * a racy peek without the bucket lock, but it is only a scheduling hint:
+ * a stale bucket choice during expansion costs nothing. */
+void assoc_prefetch(const uint32_t hv) {
+    uint64_t oldbucket;
+
+    if (expanding &&
+        (oldbucket = (hv & hashmask(hashpower - 1))) >= expand_bucket)
+    {
+        __builtin_prefetch(&old_hashtable[oldbucket], 0, 1);
+    } else {
+        __builtin_prefetch(&primary_hashtable[hv & hashmask(hashpower)], 0, 1);
+    }
+}
+
 /* returns the address of the item pointer before the key.  if *item == 0,
    the item wasn't found */
 
@@ -112,7 +152,7 @@ static item** _hashitem_before (const char *key, const size_t nkey, const uint32
         pos = &primary_hashtable[hv & hashmask(hashpower)];
     }
 
-    while (*pos && ((nkey != (*pos)->nkey) || memcmp(key, ITEM_key(*pos), nkey))) {
+    while (*pos && ((nkey != (*pos)->nkey) || !key_eq(key, ITEM_key(*pos), nkey))) {
         pos = &(*pos)->h_next;
     }
     return pos;
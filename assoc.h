@@ -2,6 +2,7 @@
 void assoc_init(const int hashpower_init);
 
 item *assoc_find(const char *key, const size_t nkey, const uint32_t hv);
+void assoc_prefetch(const uint32_t hv);
 int assoc_insert(item *item, const uint32_t hv);
 void assoc_delete(const char *key, const size_t nkey, const uint32_t hv);
 
@@ -16,9 +16,12 @@
  * rather than absolute UNIX timestamps, a space savings on systems where
  * sizeof(time_t) > sizeof(unsigned int).
  */
-volatile rel_time_t current_time;
+rel_time_t current_time;
 
 /** exported globals **/
-struct stats stats;
-struct stats_state stats_state;
-struct settings settings;
+/* stats/stats_state take writes from every worker; keep each on its own
+ * cache line so they don't ping-pong with the read-mostly settings struct
+ * laid out next to them. */
+struct stats stats CACHELINE_ALIGNED;
+struct stats_state stats_state CACHELINE_ALIGNED;
+struct settings settings CACHELINE_ALIGNED;
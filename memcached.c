@@ -115,7 +115,11 @@ conn **conns;
 void *ext_storage = NULL;
 #endif
 /** file scope variables **/
-static conn *listen_conn = NULL;
+/* Listening connections, packed into an array at startup so toggling
+ * accepts scans contiguous memory instead of chasing a list. */
+static conn **listen_conns = NULL;
+static int nlisten = 0;
+static int listen_conns_size = 0;
 static int max_fds;
 static struct event_base *main_base;
 
@@ -150,7 +154,9 @@ static enum transmit_result transmit(conn *c);
  * can block the listener via a condition.
  */
 static volatile bool allow_new_conns = true;
-static int stop_main_loop = NOT_STOP;
+/* Written from signal handlers, so it must be volatile sig_atomic_t for the
+ * main loop's read of it to be reliable. */
+static volatile sig_atomic_t stop_main_loop = NOT_STOP;
 static struct event maxconnsevent;
 static void maxconns_handler(const evutil_socket_t fd, const short which, void *arg) {
     struct timeval t = {.tv_sec = 0, .tv_usec = 10000};
@@ -167,28 +173,19 @@ static void maxconns_handler(const evutil_socket_t fd, const short which, void *
 }
 
 /*
- * given time value that's either unix time or delta from current unix time, return
- * unix time. Use the fact that delta can't exceed one month (and real time value can't
- * be that low).
+ * Cold half of realtime() (see memcached.h): absolute unix timestamps past
+ * the 30 day delta window.
  */
-rel_time_t realtime(const time_t exptime) {
-    /* no. of seconds in 30 days - largest possible delta exptime */
-
-    if (exptime == 0) return 0; /* 0 means never expire */
-
-    if (exptime > REALTIME_MAXDELTA) {
-        /* if item expiration is at/before the server started, give it an
-           expiration time of 1 second after the server started.
-           (because 0 means don't expire).  without this, we'd
-           underflow and wrap around to some large value way in the
-           future, effectively making items expiring in the past
-           really expiring never */
-        if (exptime <= process_started)
-            return (rel_time_t)1;
-        return (rel_time_t)(exptime - process_started);
-    } else {
-        return (rel_time_t)(exptime + current_time);
-    }
+rel_time_t realtime_slow(const time_t exptime) {
+    /* if item expiration is at/before the server started, give it an
+       expiration time of 1 second after the server started.
+       (because 0 means don't expire).  without this, we'd
+       underflow and wrap around to some large value way in the
+       future, effectively making items expiring in the past
+       really expiring never */
+    if (exptime <= process_started)
+        return (rel_time_t)1;
+    return (rel_time_t)(exptime - process_started);
 }
 
 static void stats_init(void) {
@@ -242,6 +239,7 @@ static void settings_init(void) {
     settings.slab_chunk_size_max = settings.slab_page_size / 2;
     settings.sasl = false;
     settings.maxconns_fast = true;
+    settings.worker_cpu_affinity = false;
     settings.lru_crawler = false;
     settings.lru_crawler_sleep = 100;
     settings.lru_crawler_tocrawl = 0;
@@ -476,25 +474,19 @@ static void conn_init(void) {
     }
 }
 
-static const char *prot_text(enum protocol prot) {
-    char *rv = "unknown";
-    switch(prot) {
-        case ascii_prot:
-            rv = "ascii";
-            break;
-        case binary_prot:
-            rv = "binary";
-            break;
-        case negotiating_prot:
-            rv = "auto-negotiate";
-            break;
+static const char *const protnames[] = { "ascii",
+                                         "binary",
+                                         "auto-negotiate",
 #ifdef PROXY
-        case proxy_prot:
-            rv = "proxy";
-            break;
+                                         "proxy",
 #endif
-    }
-    return rv;
+};
+
+static const char *prot_text(enum protocol prot) {
+    unsigned int idx = (unsigned int)prot - ascii_prot;
+    if (idx >= sizeof(protnames)/sizeof(protnames[0]))
+        return "unknown";
+    return protnames[idx];
 }
 
 void conn_close_idle(conn *c) {
@@ -605,6 +597,79 @@ void conn_io_queue_return(io_pending_t *io) {
     io->return_cb(io);
 }
 
+#ifdef HAVE_RECVMMSG
+#define UDP_RECV_BATCH 4
+/* Inbound UDP datagrams pulled in bulk with recvmmsg(); delivered to the
+ * parser one at a time by udp_rx_deliver(). */
+struct conn_udp_rx {
+    char *bufs[UDP_RECV_BATCH];   /* c->rsize bytes each */
+    struct sockaddr_in6 addrs[UDP_RECV_BATCH];
+    socklen_t addrlens[UDP_RECV_BATCH];
+    int lens[UDP_RECV_BATCH];
+    int count; /* datagrams in the current batch */
+    int next;  /* next slot to deliver */
+};
+
+static void udp_rx_free(struct conn_udp_rx *rx) {
+    int i;
+    if (rx == NULL)
+        return;
+    for (i = 0; i < UDP_RECV_BATCH; i++) {
+        if (rx->bufs[i])
+            free(rx->bufs[i]);
+    }
+    free(rx);
+}
+
+static struct conn_udp_rx *udp_rx_new(int rsize) {
+    int i;
+    struct conn_udp_rx *rx = calloc(1, sizeof(struct conn_udp_rx));
+    if (rx == NULL)
+        return NULL;
+    for (i = 0; i < UDP_RECV_BATCH; i++) {
+        rx->bufs[i] = malloc((size_t)rsize);
+        if (rx->bufs[i] == NULL) {
+            udp_rx_free(rx);
+            return NULL;
+        }
+    }
+    return rx;
+}
+
+/* Point the conn at the next buffered datagram, skipping runts and
+ * multi-packet requests. Returns true if one was delivered. */
+static bool udp_rx_deliver(conn *c) {
+    struct conn_udp_rx *rx = c->udp_rx;
+    while (rx->next < rx->count) {
+        int i = rx->next++;
+        int len = rx->lens[i];
+        unsigned char *buf = (unsigned char *)rx->bufs[i];
+        if (len <= 8)
+            continue;
+
+        /* Beginning of UDP packet is the request ID; save it. */
+        uint16_t req_id, npkts;
+        memcpy(&req_id, buf, sizeof(req_id));
+        memcpy(&npkts, buf + 4, sizeof(npkts));
+        c->request_id = ntohs(req_id);
+
+        /* If this is a multi-packet request, drop it. */
+        if (npkts != htons(1))
+            continue;
+
+        memcpy(&c->request_addr, &rx->addrs[i], sizeof(c->request_addr));
+        c->request_addr_size = rx->addrlens[i];
+
+        /* skip the frame header by parsing past it; no memmove needed. */
+        c->rbuf = rx->bufs[i];
+        c->rcurr = rx->bufs[i] + 8;
+        c->rbytes = len - 8;
+        return true;
+    }
+    return false;
+}
+#endif
+
 conn *conn_new(const int sfd, enum conn_states init_state,
                 const int event_flags,
                 const int read_buffer_size, enum network_transport transport,
@@ -633,7 +698,20 @@ conn *conn_new(const int sfd, enum conn_states init_state,
 
         // UDP connections use a persistent static buffer.
         if (c->rsize) {
+#ifdef HAVE_RECVMMSG
+            if (IS_UDP(transport)) {
+                // ... or a small ring of them, so inbound datagrams can be
+                // pulled in bulk with recvmmsg().
+                c->udp_rx = udp_rx_new(c->rsize);
+                if (c->udp_rx != NULL) {
+                    c->rbuf = c->udp_rx->bufs[0];
+                }
+            } else {
+                c->rbuf = (char *)malloc((size_t)c->rsize);
+            }
+#else
             c->rbuf = (char *)malloc((size_t)c->rsize);
+#endif
         }
 
         if (c->rsize && c->rbuf == NULL) {
@@ -646,9 +724,7 @@ conn *conn_new(const int sfd, enum conn_states init_state,
         }
 
 
-        STATS_LOCK();
-        stats_state.conn_structs++;
-        STATS_UNLOCK();
+        GLOBAL_STATS_INCR(stats_state.conn_structs);
 
         c->sfd = sfd;
         conns[sfd] = c;
@@ -777,10 +853,8 @@ conn *conn_new(const int sfd, enum conn_states init_state,
         return NULL;
     }
 
-    STATS_LOCK();
-    stats_state.curr_conns++;
-    stats.total_conns++;
-    STATS_UNLOCK();
+    GLOBAL_STATS_INCR(stats_state.curr_conns);
+    GLOBAL_STATS_INCR(stats.total_conns);
 
     MEMCACHED_CONN_ALLOCATE(c->sfd);
 
@@ -831,6 +905,14 @@ static void conn_cleanup(conn *c) {
         proxy_cleanup_conn(c);
     }
 #endif
+    if (c->stats.buffer != NULL) {
+        /* retained stats scratch buffer; any borrowing response was
+         * released by conn_release_items above. */
+        free(c->stats.buffer);
+        c->stats.buffer = NULL;
+        c->stats.size = 0;
+        c->stats.inflight = false;
+    }
     if (c->sasl_conn) {
         assert(settings.sasl);
         sasl_dispose(&c->sasl_conn);
@@ -852,6 +934,14 @@ void conn_free(conn *c) {
 
         MEMCACHED_CONN_DESTROY(c);
         conns[c->sfd] = NULL;
+#ifdef HAVE_RECVMMSG
+        if (c->udp_rx) {
+            // rbuf aliases one of the batch buffers.
+            udp_rx_free(c->udp_rx);
+            c->udp_rx = NULL;
+            c->rbuf = NULL;
+        }
+#endif
         if (c->rbuf)
             free(c->rbuf);
 #ifdef TLS
@@ -893,13 +983,15 @@ static void conn_close(conn *c) {
     }
     close(c->sfd);
     c->close_reason = 0;
-    pthread_mutex_lock(&conn_lock);
+    /* Plain volatile store: the only other writer sets it false under
+     * conn_lock from the dispatcher, and either ordering of the two bool
+     * stores yields the same outcomes as the locked version did. The
+     * maxconns_handler timer re-polls the flag every 10ms, so visibility
+     * is bounded. Skipping the mutex keeps every conn_close() from
+     * bouncing the accept lock across workers. */
     allow_new_conns = true;
-    pthread_mutex_unlock(&conn_lock);
 
-    STATS_LOCK();
-    stats_state.curr_conns--;
-    STATS_UNLOCK();
+    GLOBAL_STATS_DECR(stats_state.curr_conns);
 
     return;
 }
@@ -919,8 +1011,8 @@ void conn_close_all(void) {
 /**
  * Convert a state name to a human readable form.
  */
-static const char *state_text(enum conn_states state) {
-    const char* const statenames[] = { "conn_listening",
+static const char *const statenames[conn_max_state] = {
+                                       "conn_listening",
                                        "conn_new_cmd",
                                        "conn_waiting",
                                        "conn_read",
@@ -935,6 +1027,8 @@ static const char *state_text(enum conn_states state) {
                                        "conn_io_queue",
                                        "conn_io_resume",
                                        "conn_io_pending" };
+
+static const char *state_text(enum conn_states state) {
     return statenames[state];
 }
 
@@ -948,7 +1042,7 @@ void conn_set_state(conn *c, enum conn_states state) {
     assert(state >= conn_listening && state < conn_max_state);
 
     if (state != c->state) {
-        if (settings.verbose > 2) {
+        if (unlikely(settings.verbose > 2)) {
             fprintf(stderr, "%d: going from %s to %s\n",
                     c->sfd, state_text(c->state),
                     state_text(state));
@@ -978,7 +1072,11 @@ void resp_reset(mc_resp *resp) {
             pthread_mutex_unlock(&t->proxy_limit_lock);
         }
 #endif
-        free(resp->write_and_free);
+        if (!resp->wf_keep) {
+            free(resp->write_and_free);
+        }
+        /* wf_keep buffers stay owned by the conn's stats cache. */
+        resp->wf_keep = false;
         resp->write_and_free = NULL;
     }
     resp->wbytes = 0;
@@ -1195,7 +1293,13 @@ mc_resp* resp_finish(conn *c, mc_resp *resp) {
             pthread_mutex_unlock(&t->proxy_limit_lock);
         }
 #endif
-        free(resp->write_and_free);
+        if (resp->wf_keep && (char *)resp->write_and_free == c->stats.buffer) {
+            /* borrowed stats buffer goes back to the conn for reuse. */
+            c->stats.inflight = false;
+        } else {
+            free(resp->write_and_free);
+        }
+        resp->wf_keep = false;
     }
     if (resp->io_pending) {
         io_pending_t *io = resp->io_pending;
@@ -1220,8 +1324,7 @@ bool resp_has_stack(conn *c) {
     return c->resp_head->next != NULL ? true : false;
 }
 
-void out_string(conn *c, const char *str) {
-    size_t len;
+void out_string_len(conn *c, const char *str, size_t len) {
     assert(c != NULL);
     mc_resp *resp = c->resp;
 
@@ -1247,7 +1350,6 @@ void out_string(conn *c, const char *str) {
 
     // Fill response object with static string.
 
-    len = strlen(str);
     if ((len + 2) > WRITE_BUFFER_SIZE) {
         /* ought to be always enough. just fail for simplicity */
         str = "SERVER_ERROR output line too long";
@@ -1262,6 +1364,10 @@ void out_string(conn *c, const char *str) {
     return;
 }
 
+void out_string(conn *c, const char *str) {
+    out_string_len(c, str, strlen(str));
+}
+
 // For metaget-style ASCII commands. Ignores noreply, ensuring clients see
 // protocol level errors.
 void out_errstring(conn *c, const char *str) {
@@ -1293,6 +1399,20 @@ static void append_bin_stats(const char *key, const uint16_t klen,
                              conn *c) {
     char *buf = c->stats.buffer + c->stats.offset;
     uint32_t bodylen = klen + vlen;
+#ifdef ENDIAN_LITTLE
+    /* Pack the 24-byte header as three words, same as add_bin_header_ok;
+     * this runs once per stat line. extlen/status/cas are zero. */
+    uint64_t w0 = (uint64_t)PROTOCOL_BINARY_RES
+        | ((uint64_t)PROTOCOL_BINARY_CMD_STAT << 8)
+        | ((uint64_t)htons(klen) << 16)
+        | ((uint64_t)PROTOCOL_BINARY_RAW_BYTES << 40);
+    uint64_t w1 = (uint64_t)htonl(bodylen) | ((uint64_t)c->opaque << 32);
+    uint64_t w2 = 0;
+    memcpy(buf, &w0, 8);
+    memcpy(buf + 8, &w1, 8);
+    memcpy(buf + 16, &w2, 8);
+    buf += sizeof(protocol_binary_response_header);
+#else
     protocol_binary_response_header header = {
         .response.magic = (uint8_t)PROTOCOL_BINARY_RES,
         .response.opcode = PROTOCOL_BINARY_CMD_STAT,
@@ -1304,6 +1424,7 @@ static void append_bin_stats(const char *key, const uint16_t klen,
 
     memcpy(buf, header.bytes, sizeof(header.response));
     buf += sizeof(header.response);
+#endif
 
     if (klen > 0) {
         memcpy(buf, key, klen);
@@ -1314,33 +1435,52 @@ static void append_bin_stats(const char *key, const uint16_t klen,
         }
     }
 
-    c->stats.offset += sizeof(header.response) + bodylen;
+    c->stats.offset += sizeof(protocol_binary_response_header) + bodylen;
 }
 
 static void append_ascii_stats(const char *key, const uint16_t klen,
                                const char *val, const uint32_t vlen,
                                conn *c) {
+    /* caller (append_stats) grew the buffer by klen + vlen + 10, so the
+     * line is assembled with raw copies instead of snprintf formatting. */
     char *pos = c->stats.buffer + c->stats.offset;
-    uint32_t nbytes = 0;
-    int remaining = c->stats.size - c->stats.offset;
-    int room = remaining - 1;
+    uint32_t nbytes;
 
     if (klen == 0 && vlen == 0) {
-        nbytes = snprintf(pos, room, "END\r\n");
-    } else if (vlen == 0) {
-        nbytes = snprintf(pos, room, "STAT %s\r\n", key);
+        memcpy(pos, "END\r\n", 5);
+        nbytes = 5;
     } else {
-        nbytes = snprintf(pos, room, "STAT %s %s\r\n", key, val);
+        memcpy(pos, "STAT ", 5);
+        memcpy(pos + 5, key, klen);
+        nbytes = 5 + klen;
+        if (vlen != 0) {
+            pos[nbytes++] = ' ';
+            memcpy(pos + nbytes, val, vlen);
+            nbytes += vlen;
+        }
+        pos[nbytes++] = '\r';
+        pos[nbytes++] = '\n';
     }
 
     c->stats.offset += nbytes;
 }
 
 static bool grow_stats_buf(conn *c, size_t needed) {
-    size_t nsize = c->stats.size;
-    size_t available = nsize - c->stats.offset;
+    size_t nsize;
+    size_t available;
     bool rv = true;
 
+    /* If a previous stats response is still queued on this buffer (pipelined
+     * stats commands), abandon it to that response -- resp_finish sees the
+     * pointer no longer matches and frees it -- and start fresh. */
+    if (c->stats.inflight) {
+        c->stats.buffer = NULL;
+        c->stats.inflight = false;
+    }
+
+    nsize = c->stats.size;
+    available = nsize - c->stats.offset;
+
     /* Special case: No buffer -- need to allocate fresh */
     if (c->stats.buffer == NULL) {
         nsize = 1024;
@@ -1411,6 +1551,14 @@ static void reset_cmd_handler(conn *c) {
         }
         c->item = NULL;
     }
+#ifdef HAVE_RECVMMSG
+    // UDP: pull the next datagram from the current recvmmsg() batch before
+    // deciding to wait; the socket may not poll readable again while we
+    // still hold buffered requests.
+    if (c->rbytes == 0 && c->udp_rx != NULL && c->udp_rx->next < c->udp_rx->count) {
+        udp_rx_deliver(c);
+    }
+#endif
     if (c->rbytes > 0) {
         conn_set_state(c, conn_parse_cmd);
     } else if (c->resp_head) {
@@ -1521,8 +1669,10 @@ static int _store_item_copy_data(int comm, item *old_it, item *new_it, item *add
                 return -1;
             }
         } else {
-            memcpy(ITEM_data(new_it), ITEM_data(old_it), old_it->nbytes);
-            memcpy(ITEM_data(new_it) + old_it->nbytes - 2 /* CRLF */, ITEM_data(add_it), add_it->nbytes);
+            /* trim the CRLF off the first half instead of overwriting it */
+            char *d = ITEM_data(new_it);
+            memcpy(d, ITEM_data(old_it), old_it->nbytes - 2 /* CRLF */);
+            memcpy(d + old_it->nbytes - 2, ITEM_data(add_it), add_it->nbytes);
         }
     } else {
         /* NREAD_PREPEND */
@@ -1532,8 +1682,9 @@ static int _store_item_copy_data(int comm, item *old_it, item *new_it, item *add
                 return -1;
             }
         } else {
-            memcpy(ITEM_data(new_it), ITEM_data(add_it), add_it->nbytes);
-            memcpy(ITEM_data(new_it) + add_it->nbytes - 2 /* CRLF */, ITEM_data(old_it), old_it->nbytes);
+            char *d = ITEM_data(new_it);
+            memcpy(d, ITEM_data(add_it), add_it->nbytes - 2 /* CRLF */);
+            memcpy(d + add_it->nbytes - 2, ITEM_data(old_it), old_it->nbytes);
         }
     }
     return 0;
@@ -1726,7 +1877,22 @@ void write_and_free(conn *c, char *buf, int bytes) {
     }
 }
 
-void append_stat(const char *name, ADD_STAT add_stats, conn *c,
+/* Queue the conn's assembled stats buffer for transmit while the conn keeps
+ * the allocation, so the next stats command reuses it instead of paying a
+ * malloc/free round trip. The response borrows the pointer (wf_keep);
+ * resp_finish hands it back, or frees it if the conn moved on to a fresh
+ * buffer in the meantime. */
+void write_stats_buf(conn *c) {
+    mc_resp *resp = c->resp;
+    resp->write_and_free = c->stats.buffer;
+    resp->wf_keep = true;
+    resp_add_iov(resp, c->stats.buffer, c->stats.offset);
+    c->stats.inflight = true;
+    c->stats.offset = 0;
+    conn_set_state(c, conn_new_cmd);
+}
+
+void append_stat(const char *name, const size_t klen, ADD_STAT add_stats, conn *c,
                  const char *fmt, ...) {
     char val_str[STAT_VAL_LEN];
     int vlen;
@@ -1741,7 +1907,7 @@ void append_stat(const char *name, ADD_STAT add_stats, conn *c,
     vlen = vsnprintf(val_str, sizeof(val_str) - 1, fmt, ap);
     va_end(ap);
 
-    add_stats(name, strlen(name), val_str, vlen, c);
+    add_stats(name, klen, val_str, vlen, c);
 }
 
 /* return server specific stats only */
@@ -1758,7 +1924,12 @@ void server_stats(ADD_STAT add_stats, void *c) {
     getrusage(RUSAGE_SELF, &usage);
 #endif /* !WIN32 */
 
+    /* Snapshot the globals under the lock, then format from the copies so
+     * the lock isn't held across dozens of APPEND_STAT calls. */
     STATS_LOCK();
+    struct stats stats_snap = stats;
+    struct stats_state state_snap = stats_state;
+    STATS_UNLOCK();
 
     APPEND_STAT("pid", "%lu", (long)pid);
     APPEND_STAT("uptime", "%u", now - ITEM_UPDATE_INTERVAL);
@@ -1768,21 +1939,21 @@ void server_stats(ADD_STAT add_stats, void *c) {
     APPEND_STAT("pointer_size", "%d", (int)(8 * sizeof(void *)));
 
 #ifndef WIN32
-    append_stat("rusage_user", add_stats, c, "%ld.%06ld",
+    append_stat("rusage_user", sizeof("rusage_user") - 1, add_stats, c, "%ld.%06ld",
                 (long)usage.ru_utime.tv_sec,
                 (long)usage.ru_utime.tv_usec);
-    append_stat("rusage_system", add_stats, c, "%ld.%06ld",
+    append_stat("rusage_system", sizeof("rusage_system") - 1, add_stats, c, "%ld.%06ld",
                 (long)usage.ru_stime.tv_sec,
                 (long)usage.ru_stime.tv_usec);
 #endif /* !WIN32 */
 
     APPEND_STAT("max_connections", "%d", settings.maxconns);
-    APPEND_STAT("curr_connections", "%llu", (unsigned long long)stats_state.curr_conns - 1);
-    APPEND_STAT("total_connections", "%llu", (unsigned long long)stats.total_conns);
+    APPEND_STAT("curr_connections", "%llu", (unsigned long long)state_snap.curr_conns - 1);
+    APPEND_STAT("total_connections", "%llu", (unsigned long long)stats_snap.total_conns);
     if (settings.maxconns_fast) {
-        APPEND_STAT("rejected_connections", "%llu", (unsigned long long)stats.rejected_conns);
+        APPEND_STAT("rejected_connections", "%llu", (unsigned long long)stats_snap.rejected_conns);
     }
-    APPEND_STAT("connection_structures", "%u", stats_state.conn_structs);
+    APPEND_STAT("connection_structures", "%u", state_snap.conn_structs);
     APPEND_STAT("response_obj_oom", "%llu", (unsigned long long)thread_stats.response_obj_oom);
     APPEND_STAT("response_obj_count", "%llu", (unsigned long long)thread_stats.response_obj_count);
     APPEND_STAT("response_obj_bytes", "%llu", (unsigned long long)thread_stats.response_obj_bytes);
@@ -1790,7 +1961,7 @@ void server_stats(ADD_STAT add_stats, void *c) {
     APPEND_STAT("read_buf_bytes", "%llu", (unsigned long long)thread_stats.read_buf_bytes);
     APPEND_STAT("read_buf_bytes_free", "%llu", (unsigned long long)thread_stats.read_buf_bytes_free);
     APPEND_STAT("read_buf_oom", "%llu", (unsigned long long)thread_stats.read_buf_oom);
-    APPEND_STAT("reserved_fds", "%u", stats_state.reserved_fds);
+    APPEND_STAT("reserved_fds", "%u", state_snap.reserved_fds);
 #ifdef PROXY
     if (settings.proxy_enabled) {
         APPEND_STAT("proxy_conn_requests", "%llu", (unsigned long long)thread_stats.proxy_conn_requests);
@@ -1839,39 +2010,38 @@ void server_stats(ADD_STAT add_stats, void *c) {
     APPEND_STAT("bytes_read", "%llu", (unsigned long long)thread_stats.bytes_read);
     APPEND_STAT("bytes_written", "%llu", (unsigned long long)thread_stats.bytes_written);
     APPEND_STAT("limit_maxbytes", "%llu", (unsigned long long)settings.maxbytes);
-    APPEND_STAT("accepting_conns", "%u", stats_state.accepting_conns);
-    APPEND_STAT("listen_disabled_num", "%llu", (unsigned long long)stats.listen_disabled_num);
-    APPEND_STAT("time_in_listen_disabled_us", "%llu", stats.time_in_listen_disabled_us);
+    APPEND_STAT("accepting_conns", "%u", state_snap.accepting_conns);
+    APPEND_STAT("listen_disabled_num", "%llu", (unsigned long long)stats_snap.listen_disabled_num);
+    APPEND_STAT("time_in_listen_disabled_us", "%llu", stats_snap.time_in_listen_disabled_us);
     APPEND_STAT("threads", "%d", settings.num_threads);
     APPEND_STAT("conn_yields", "%llu", (unsigned long long)thread_stats.conn_yields);
-    APPEND_STAT("hash_power_level", "%u", stats_state.hash_power_level);
-    APPEND_STAT("hash_bytes", "%llu", (unsigned long long)stats_state.hash_bytes);
-    APPEND_STAT("hash_is_expanding", "%u", stats_state.hash_is_expanding);
+    APPEND_STAT("hash_power_level", "%u", state_snap.hash_power_level);
+    APPEND_STAT("hash_bytes", "%llu", (unsigned long long)state_snap.hash_bytes);
+    APPEND_STAT("hash_is_expanding", "%u", state_snap.hash_is_expanding);
     if (settings.slab_reassign) {
-        APPEND_STAT("slab_reassign_rescues", "%llu", stats.slab_reassign_rescues);
-        APPEND_STAT("slab_reassign_chunk_rescues", "%llu", stats.slab_reassign_chunk_rescues);
-        APPEND_STAT("slab_reassign_inline_reclaim", "%llu", stats.slab_reassign_inline_reclaim);
-        APPEND_STAT("slab_reassign_busy_items", "%llu", stats.slab_reassign_busy_items);
-        APPEND_STAT("slab_reassign_busy_deletes", "%llu", stats.slab_reassign_busy_deletes);
-        APPEND_STAT("slab_reassign_busy_nomem", "%llu", stats.slab_reassign_busy_nomem);
-        APPEND_STAT("slab_reassign_running", "%u", stats_state.slab_reassign_running);
-        APPEND_STAT("slabs_moved", "%llu", stats.slabs_moved);
+        APPEND_STAT("slab_reassign_rescues", "%llu", stats_snap.slab_reassign_rescues);
+        APPEND_STAT("slab_reassign_chunk_rescues", "%llu", stats_snap.slab_reassign_chunk_rescues);
+        APPEND_STAT("slab_reassign_inline_reclaim", "%llu", stats_snap.slab_reassign_inline_reclaim);
+        APPEND_STAT("slab_reassign_busy_items", "%llu", stats_snap.slab_reassign_busy_items);
+        APPEND_STAT("slab_reassign_busy_deletes", "%llu", stats_snap.slab_reassign_busy_deletes);
+        APPEND_STAT("slab_reassign_busy_nomem", "%llu", stats_snap.slab_reassign_busy_nomem);
+        APPEND_STAT("slab_reassign_running", "%u", state_snap.slab_reassign_running);
+        APPEND_STAT("slabs_moved", "%llu", stats_snap.slabs_moved);
     }
     if (settings.lru_crawler) {
-        APPEND_STAT("lru_crawler_running", "%u", stats_state.lru_crawler_running);
-        APPEND_STAT("lru_crawler_starts", "%u", stats.lru_crawler_starts);
+        APPEND_STAT("lru_crawler_running", "%u", state_snap.lru_crawler_running);
+        APPEND_STAT("lru_crawler_starts", "%u", stats_snap.lru_crawler_starts);
     }
     if (settings.lru_maintainer_thread) {
-        APPEND_STAT("lru_maintainer_juggles", "%llu", (unsigned long long)stats.lru_maintainer_juggles);
+        APPEND_STAT("lru_maintainer_juggles", "%llu", (unsigned long long)stats_snap.lru_maintainer_juggles);
     }
     APPEND_STAT("malloc_fails", "%llu",
-                (unsigned long long)stats.malloc_fails);
-    APPEND_STAT("log_worker_dropped", "%llu", (unsigned long long)stats.log_worker_dropped);
-    APPEND_STAT("log_worker_written", "%llu", (unsigned long long)stats.log_worker_written);
-    APPEND_STAT("log_watcher_skipped", "%llu", (unsigned long long)stats.log_watcher_skipped);
-    APPEND_STAT("log_watcher_sent", "%llu", (unsigned long long)stats.log_watcher_sent);
-    APPEND_STAT("log_watchers", "%llu", (unsigned long long)stats_state.log_watchers);
-    STATS_UNLOCK();
+                (unsigned long long)stats_snap.malloc_fails);
+    APPEND_STAT("log_worker_dropped", "%llu", (unsigned long long)stats_snap.log_worker_dropped);
+    APPEND_STAT("log_worker_written", "%llu", (unsigned long long)stats_snap.log_worker_written);
+    APPEND_STAT("log_watcher_skipped", "%llu", (unsigned long long)stats_snap.log_watcher_skipped);
+    APPEND_STAT("log_watcher_sent", "%llu", (unsigned long long)stats_snap.log_watcher_sent);
+    APPEND_STAT("log_watchers", "%llu", (unsigned long long)state_snap.log_watchers);
 #ifdef EXTSTORE
     storage_stats(add_stats, c);
 #endif
@@ -1881,15 +2051,15 @@ void server_stats(ADD_STAT add_stats, void *c) {
 #ifdef TLS
     if (settings.ssl_enabled) {
         if (settings.ssl_session_cache) {
-            APPEND_STAT("ssl_new_sessions", "%llu", (unsigned long long)stats.ssl_new_sessions);
+            APPEND_STAT("ssl_new_sessions", "%llu", (unsigned long long)stats_snap.ssl_new_sessions);
         }
-        APPEND_STAT("ssl_handshake_errors", "%llu", (unsigned long long)stats.ssl_handshake_errors);
-        APPEND_STAT("ssl_proto_errors", "%llu", (unsigned long long)stats.ssl_proto_errors);
+        APPEND_STAT("ssl_handshake_errors", "%llu", (unsigned long long)stats_snap.ssl_handshake_errors);
+        APPEND_STAT("ssl_proto_errors", "%llu", (unsigned long long)stats_snap.ssl_proto_errors);
         APPEND_STAT("time_since_server_cert_refresh", "%u", (now >= settings.ssl_last_cert_refresh_time) ? (now - settings.ssl_last_cert_refresh_time) : 0);
     }
 #endif
-    APPEND_STAT("unexpected_napi_ids", "%llu", (unsigned long long)stats.unexpected_napi_ids);
-    APPEND_STAT("round_robin_fallback", "%llu", (unsigned long long)stats.round_robin_fallback);
+    APPEND_STAT("unexpected_napi_ids", "%llu", (unsigned long long)stats_snap.unexpected_napi_ids);
+    APPEND_STAT("round_robin_fallback", "%llu", (unsigned long long)stats_snap.round_robin_fallback);
 }
 
 void process_stat_settings(ADD_STAT add_stats, void *c) {
@@ -1923,6 +2093,7 @@ void process_stat_settings(ADD_STAT add_stats, void *c) {
     APPEND_STAT("auth_enabled_ascii", "%s", settings.auth_file ? settings.auth_file : "no");
     APPEND_STAT("item_size_max", "%d", settings.item_size_max);
     APPEND_STAT("maxconns_fast", "%s", settings.maxconns_fast ? "yes" : "no");
+    APPEND_STAT("worker_cpu_affinity", "%s", settings.worker_cpu_affinity ? "yes" : "no");
     APPEND_STAT("hashpower_init", "%d", settings.hashpower_init);
     APPEND_STAT("slab_reassign", "%s", settings.slab_reassign ? "yes" : "no");
     APPEND_STAT("slab_automove", "%d", settings.slab_automove);
@@ -2226,7 +2397,8 @@ item* limited_get_locked(const char *key, size_t nkey, LIBEVENT_THREAD *t, bool
  */
 enum delta_result_type do_add_delta(LIBEVENT_THREAD *t, const char *key, const size_t nkey,
                                     const bool incr, const int64_t delta,
-                                    char *buf, uint64_t *cas,
+                                    char *buf, size_t *len_out,
+                                    uint64_t *cas,
                                     const uint32_t hv,
                                     item **it_ret) {
     char *ptr;
@@ -2257,7 +2429,20 @@ enum delta_result_type do_add_delta(LIBEVENT_THREAD *t, const char *key, const s
 
     ptr = ITEM_data(it);
 
-    if (!safe_strtoull(ptr, &value)) {
+    /* Counter values are short digit runs the server wrote itself; parse
+     * with a tight loop and only fall back to safe_strtoull for the odd
+     * cases (signs, leading whitespace, values near the 64bit limit). */
+    const char *dp = ptr;
+    uint64_t fastval = 0;
+    int ndigits = 0;
+    while (*dp >= '0' && *dp <= '9' && ndigits < 19) {
+        fastval = fastval * 10 + (uint64_t)(*dp++ - '0');
+        ndigits++;
+    }
+    if (ndigits > 0 &&
+        (*dp == '\r' || *dp == '\n' || *dp == ' ' || *dp == '\0')) {
+        value = fastval;
+    } else if (!safe_strtoull(ptr, &value)) {
         do_item_remove(it);
         return NON_NUMERIC;
     }
@@ -2266,11 +2451,11 @@ enum delta_result_type do_add_delta(LIBEVENT_THREAD *t, const char *key, const s
         value += delta;
         //MEMCACHED_COMMAND_INCR(c->sfd, ITEM_key(it), it->nkey, value);
     } else {
-        if(delta > value) {
-            value = 0;
-        } else {
-            value -= delta;
-        }
+        /* Clamp to zero on underflow without a data-dependent branch; the
+         * compiler turns this into sub + cmov. */
+        uint64_t diff;
+        bool underflow = __builtin_sub_overflow(value, (uint64_t)delta, &diff);
+        value = underflow ? 0 : diff;
         //MEMCACHED_COMMAND_DECR(c->sfd, ITEM_key(it), it->nkey, value);
     }
 
@@ -2282,8 +2467,10 @@ enum delta_result_type do_add_delta(LIBEVENT_THREAD *t, const char *key, const s
     }
     pthread_mutex_unlock(&t->stats.mutex);
 
-    itoa_u64(value, buf);
-    res = strlen(buf);
+    res = itoa_u64(value, buf) - buf;
+    if (len_out != NULL) {
+        *len_out = res;
+    }
     /* refcount == 2 means we are the only ones holding the item, and it is
      * linked. We hold the item's lock in this function, so refcount cannot
      * increase. */
@@ -2365,7 +2552,9 @@ static int try_read_command_udp(conn *c) {
     assert(c->rcurr <= (c->rbuf + c->rsize));
     assert(c->rbytes > 0);
 
-    if ((unsigned char)c->rbuf[0] == (unsigned char)PROTOCOL_BINARY_REQ) {
+    // NB: rcurr, not rbuf: batched datagrams keep their frame header in
+    // place and deliver the payload via rcurr.
+    if ((unsigned char)c->rcurr[0] == (unsigned char)PROTOCOL_BINARY_REQ) {
         c->protocol = binary_prot;
         return try_read_command_binary(c);
     } else {
@@ -2382,30 +2571,67 @@ static enum try_read_result try_read_udp(conn *c) {
 
     assert(c != NULL);
 
+#ifdef HAVE_RECVMMSG
+    struct conn_udp_rx *rx = c->udp_rx;
+    if (rx != NULL) {
+        if (rx->next >= rx->count) {
+            struct mmsghdr vmsgs[UDP_RECV_BATCH];
+            struct iovec iovs[UDP_RECV_BATCH];
+            uint64_t totbytes = 0;
+            int i;
+            for (i = 0; i < UDP_RECV_BATCH; i++) {
+                iovs[i].iov_base = rx->bufs[i];
+                iovs[i].iov_len = c->rsize;
+                vmsgs[i] = (struct mmsghdr){ .msg_hdr = {
+                    .msg_name = &rx->addrs[i],
+                    .msg_namelen = sizeof(rx->addrs[i]),
+                    .msg_iov = &iovs[i],
+                    .msg_iovlen = 1,
+                }};
+            }
+            res = recvmmsg(c->sfd, vmsgs, UDP_RECV_BATCH, MSG_DONTWAIT, NULL);
+            if (res <= 0) {
+                return READ_NO_DATA_RECEIVED;
+            }
+            for (i = 0; i < res; i++) {
+                rx->lens[i] = vmsgs[i].msg_len;
+                rx->addrlens[i] = vmsgs[i].msg_hdr.msg_namelen;
+                totbytes += vmsgs[i].msg_len;
+            }
+            rx->count = res;
+            rx->next = 0;
+            THR_STATS_ADD(c->thread, bytes_read, totbytes);
+        }
+        if (udp_rx_deliver(c)) {
+            return READ_DATA_RECEIVED;
+        }
+        return READ_NO_DATA_RECEIVED;
+    }
+#endif
+
     c->request_addr_size = sizeof(c->request_addr);
     res = recvfrom(c->sfd, c->rbuf, c->rsize,
                    0, (struct sockaddr *)&c->request_addr,
                    &c->request_addr_size);
     if (res > 8) {
         unsigned char *buf = (unsigned char *)c->rbuf;
-        pthread_mutex_lock(&c->thread->stats.mutex);
-        c->thread->stats.bytes_read += res;
-        pthread_mutex_unlock(&c->thread->stats.mutex);
+        THR_STATS_ADD(c->thread, bytes_read, res);
 
         /* Beginning of UDP packet is the request ID; save it. */
-        c->request_id = buf[0] * 256 + buf[1];
+        uint16_t req_id, npkts;
+        memcpy(&req_id, buf, sizeof(req_id));
+        memcpy(&npkts, buf + 4, sizeof(npkts));
+        c->request_id = ntohs(req_id);
 
         /* If this is a multi-packet request, drop it. */
-        if (buf[4] != 0 || buf[5] != 1) {
+        if (npkts != htons(1)) {
             return READ_NO_DATA_RECEIVED;
         }
 
-        /* Don't care about any of the rest of the header. */
-        res -= 8;
-        memmove(c->rbuf, c->rbuf + 8, res);
-
-        c->rbytes = res;
-        c->rcurr = c->rbuf;
+        /* Don't care about any of the rest of the header; parse past it
+         * instead of shifting the payload down. */
+        c->rbytes = res - 8;
+        c->rcurr = c->rbuf + 8;
         return READ_DATA_RECEIVED;
     }
     return READ_NO_DATA_RECEIVED;
@@ -2430,9 +2656,29 @@ static enum try_read_result try_read_network(conn *c) {
     assert(c != NULL);
 
     if (c->rcurr != c->rbuf) {
-        if (c->rbytes > 0) /* otherwise there's nothing to copy */
-            memmove(c->rbuf, c->rcurr, c->rbytes);
-        c->rcurr = c->rbuf;
+        if (c->rbytes == 0) {
+            c->rcurr = c->rbuf;
+        } else if (!c->rbuf_malloced &&
+                   (c->rcurr - c->rbuf) + c->rbytes + 2048 <= c->rsize) {
+            /* plenty of tail room left in the fixed buffer; leave the
+             * fragment where it is and keep appending behind it. The next
+             * pass realigns once the tail actually runs low. */
+        } else {
+            /* leftover is usually a few bytes of partial command; copy it
+             * inline rather than calling out to memmove. dst is below src so
+             * a forward copy is overlap-safe. */
+            if (c->rbytes <= 32) {
+                char *dst = c->rbuf;
+                const char *src = c->rcurr;
+                int x;
+                for (x = 0; x < c->rbytes; x++) {
+                    dst[x] = src[x];
+                }
+            } else {
+                memmove(c->rbuf, c->rcurr, c->rbytes);
+            }
+            c->rcurr = c->rbuf;
+        }
     }
 
     while (1) {
@@ -2459,12 +2705,10 @@ static enum try_read_result try_read_network(conn *c) {
             c->rsize *= 2;
         }
 
-        int avail = c->rsize - c->rbytes;
-        res = c->read(c, c->rbuf + c->rbytes, avail);
+        int avail = c->rsize - (int)(c->rcurr - c->rbuf) - c->rbytes;
+        res = c->read(c, c->rcurr + c->rbytes, avail);
         if (res > 0) {
-            pthread_mutex_lock(&c->thread->stats.mutex);
-            c->thread->stats.bytes_read += res;
-            pthread_mutex_unlock(&c->thread->stats.mutex);
+            THR_STATS_ADD(c->thread, bytes_read, res);
             gotdata = READ_DATA_RECEIVED;
             c->rbytes += res;
             if (res == avail && c->rbuf_malloced) {
@@ -2502,13 +2746,28 @@ static bool update_event(conn *c, const int new_flags) {
     return true;
 }
 
+/* Startup-only: register a listening connection for accept toggling. */
+static void listen_conn_append(conn *add) {
+    if (nlisten >= listen_conns_size) {
+        listen_conns_size = listen_conns_size == 0 ? 8 : listen_conns_size * 2;
+        conn **new_conns = realloc(listen_conns, sizeof(conn *) * listen_conns_size);
+        if (new_conns == NULL) {
+            fprintf(stderr, "Failed to grow listener array\n");
+            exit(EXIT_FAILURE);
+        }
+        listen_conns = new_conns;
+    }
+    listen_conns[nlisten++] = add;
+}
+
 /*
  * Sets whether we are listening for new connections or not.
  */
 void do_accept_new_conns(const bool do_accept) {
-    conn *next;
+    int i;
 
-    for (next = listen_conn; next; next = next->next) {
+    for (i = 0; i < nlisten; i++) {
+        conn *next = listen_conns[i];
         if (do_accept) {
             update_event(next, EV_READ | EV_PERSIST);
             if (listen(next->sfd, settings.backlog) != 0) {
@@ -2547,9 +2806,15 @@ void do_accept_new_conns(const bool do_accept) {
 
 #define TRANSMIT_ONE_RESP true
 #define TRANSMIT_ALL_RESP false
-static int _transmit_pre(conn *c, struct iovec *iovs, int iovused, bool one_resp) {
+static int _transmit_pre(conn *c, struct iovec *iovs, int iovused, bool one_resp, bool *more) {
     mc_resp *resp = c->resp_head;
     while (resp && iovused + resp->iovcnt < IOV_MAX-1) {
+        // resp objects come from pooled bundles and a long multi-GET chain
+        // walks many of them; start pulling the next one in while we copy
+        // this one's iovecs.
+        if (resp->next) {
+            __builtin_prefetch(resp->next, 0, 1);
+        }
         if (resp->skip) {
             // Don't actually unchain the resp obj here since it's singly-linked.
             // Just let the post function handle it linearly.
@@ -2609,6 +2874,11 @@ static int _transmit_pre(conn *c, struct iovec *iovs, int iovused, bool one_resp
         if (one_resp)
             break;
     }
+    // Report whether queued responses didn't fit this pass so the caller
+    // can hint the kernel that another send follows immediately.
+    if (more) {
+        *more = (resp != NULL);
+    }
     return iovused;
 }
 
@@ -2678,14 +2948,13 @@ static void _transmit_post(conn *c, ssize_t res) {
 static enum transmit_result transmit(conn *c) {
     assert(c != NULL);
     struct iovec iovs[IOV_MAX];
-    struct msghdr msg;
+    // let the initializer zero the fields we don't use rather than
+    // memset()ing the whole struct.
+    struct msghdr msg = { .msg_iov = iovs };
     int iovused = 0;
 
-    // init the msg.
-    memset(&msg, 0, sizeof(struct msghdr));
-    msg.msg_iov = iovs;
-
-    iovused = _transmit_pre(c, iovs, iovused, TRANSMIT_ALL_RESP);
+    bool more = false;
+    iovused = _transmit_pre(c, iovs, iovused, TRANSMIT_ALL_RESP, &more);
     if (iovused == 0) {
         // Avoid the syscall if we're only handling a noreply.
         // Return the response object.
@@ -2696,11 +2965,12 @@ static enum transmit_result transmit(conn *c) {
     // Alright, send.
     ssize_t res;
     msg.msg_iovlen = iovused;
-    res = c->sendmsg(c, &msg, 0);
+    // If more responses are queued than fit in one iovec pass, tell the
+    // kernel not to flush a short final segment: the next transmit call
+    // follows immediately with the rest.
+    res = c->sendmsg(c, &msg, more ? MSG_MORE : 0);
     if (res >= 0) {
-        pthread_mutex_lock(&c->thread->stats.mutex);
-        c->thread->stats.bytes_written += res;
-        pthread_mutex_unlock(&c->thread->stats.mutex);
+        THR_STATS_ADD(c->thread, bytes_written, res);
 
         // Decrement any partial IOV's and complete any finished resp's.
         _transmit_post(c, res);
@@ -2747,23 +3017,69 @@ static void build_udp_header(unsigned char *hdr, mc_resp *resp) {
         resp->udp_total = total;
     }
 
-    // TODO: why wasn't this hto*'s and casts?
-    // this ends up sending UDP hdr data specifically in host byte order.
-    *hdr++ = resp->request_id / 256;
-    *hdr++ = resp->request_id % 256;
-    *hdr++ = resp->udp_sequence / 256;
-    *hdr++ = resp->udp_sequence % 256;
-    *hdr++ = resp->udp_total / 256;
-    *hdr++ = resp->udp_total % 256;
-    *hdr++ = 0;
-    *hdr++ = 0;
+    // Pack the header as three network-order shorts plus reserved zeroes and
+    // emit it with one 8-byte copy instead of byte-at-a-time stores. htons()
+    // produces the same high-byte-first layout the old /256,%256 pairs did.
+    uint16_t hdr16[4] = {
+        htons(resp->request_id),
+        htons(resp->udp_sequence),
+        htons(resp->udp_total),
+        0
+    };
+    memcpy(hdr, hdr16, UDP_HEADER_SIZE);
     resp->udp_sequence++;
 }
 
+#ifdef HAVE_SENDMMSG
+#define UDP_SEND_BATCH 16
+/*
+ * Batched UDP transmit: push one datagram per pending response via a single
+ * sendmmsg() call. Only responses that fit within one packet are batched;
+ * anything larger (or chunked) falls back to the one-packet-per-call path
+ * below. Returns the number of datagrams assembled, or 0 if the head of the
+ * queue isn't batchable; *sent is filled with the sendmmsg() result.
+ */
+static int transmit_udp_build_batch(conn *c, struct mmsghdr *vmsgs,
+        struct iovec *iovs, unsigned char *hdrs, mc_resp **brs) {
+    mc_resp *resp = c->resp_head;
+    int n = 0;
+    int iovused = 0;
+
+    for (; resp && n < UDP_SEND_BATCH; resp = resp->next) {
+        if (resp->skip) {
+            // _transmit_post() reaps skipped responses in-line.
+            continue;
+        }
+        if (resp->chunked_data_iov != 0
+            || resp->tosend + UDP_HEADER_SIZE > UDP_MAX_PAYLOAD_SIZE
+            || iovused + resp->iovcnt + 1 > IOV_MAX) {
+            break;
+        }
+        unsigned char *hdr = hdrs + n * UDP_HEADER_SIZE;
+        iovs[iovused].iov_base = (void *)hdr;
+        iovs[iovused].iov_len = UDP_HEADER_SIZE;
+        build_udp_header(hdr, resp);
+
+        vmsgs[n] = (struct mmsghdr){ .msg_hdr = {
+            .msg_name = &resp->request_addr,
+            .msg_namelen = resp->request_addr_size,
+            .msg_iov = &iovs[iovused],
+            .msg_iovlen = resp->iovcnt + 1,
+        }};
+        iovused++;
+        memcpy(&iovs[iovused], resp->iov, sizeof(struct iovec)*resp->iovcnt);
+        iovused += resp->iovcnt;
+
+        brs[n] = resp;
+        n++;
+    }
+    return n;
+}
+#endif
+
 /*
  * UDP specific transmit function. Uses its own function rather than check
- * IS_UDP() five times. If we ever implement sendmmsg or similar support they
- * will diverge even more.
+ * IS_UDP() five times.
  * Does not use TLS.
  *
  * Returns:
@@ -2788,18 +3104,64 @@ static enum transmit_result transmit_udp(conn *c) {
         return TRANSMIT_COMPLETE;
     }
 
+#ifdef HAVE_SENDMMSG
+    // Multiple pending responses: try to flush one datagram each with a
+    // single syscall.
+    if (resp->next) {
+        struct mmsghdr vmsgs[UDP_SEND_BATCH];
+        struct iovec biovs[IOV_MAX];
+        unsigned char udp_hdrs[UDP_SEND_BATCH * UDP_HEADER_SIZE];
+        mc_resp *brs[UDP_SEND_BATCH];
+        int n = transmit_udp_build_batch(c, vmsgs, biovs, udp_hdrs, brs);
+        if (n > 1) {
+            int x;
+            int sent = sendmmsg(c->sfd, vmsgs, n, 0);
+            if (sent > 0) {
+                ssize_t tosend = 0;
+                for (x = 0; x < n; x++) {
+                    if (x < sent) {
+                        tosend += brs[x]->tosend;
+                    } else {
+                        // Unsent: undo the header sequence bump so a retry
+                        // rebuilds the identical packet.
+                        brs[x]->udp_sequence--;
+                    }
+                }
+                THR_STATS_ADD(c->thread, bytes_written, tosend + sent * UDP_HEADER_SIZE);
+
+                _transmit_post(c, tosend);
+
+                if (c->resp_head) {
+                    return TRANSMIT_INCOMPLETE;
+                } else {
+                    return TRANSMIT_COMPLETE;
+                }
+            }
+            // Error: roll the headers back and fall through so the
+            // single-packet path below repeats the error handling.
+            for (x = 0; x < n; x++) {
+                brs[x]->udp_sequence--;
+            }
+        } else if (n == 1) {
+            // Head of the queue was batchable but nothing else was; undo
+            // the header and take the single-packet path.
+            brs[0]->udp_sequence--;
+        }
+    }
+#endif
+
     if (resp->skip) {
         resp = resp_finish(c, resp);
         return TRANSMIT_INCOMPLETE;
     }
 
-    // clear the message and initialize it.
-    memset(&msg, 0, sizeof(struct msghdr));
-    msg.msg_iov = iovs;
-
-    // the UDP source to return to.
-    msg.msg_name = &resp->request_addr;
-    msg.msg_namelen = resp->request_addr_size;
+    // initialize the message; unset fields zeroed by the initializer.
+    // msg_name is the UDP source to return to.
+    msg = (struct msghdr){
+        .msg_name = &resp->request_addr,
+        .msg_namelen = resp->request_addr_size,
+        .msg_iov = iovs,
+    };
 
     // First IOV is the custom UDP header.
     iovs[0].iov_base = (void *)udp_hdr;
@@ -2810,7 +3172,7 @@ static enum transmit_result transmit_udp(conn *c) {
     // Fill the IOV's the standard way.
     // TODO: might get a small speedup if we let it break early with a length
     // limit.
-    iovused = _transmit_pre(c, iovs, iovused, TRANSMIT_ONE_RESP);
+    iovused = _transmit_pre(c, iovs, iovused, TRANSMIT_ONE_RESP, NULL);
 
     // Clip the IOV's to the max UDP packet size.
     // If we add support for send_mmsg, this can be where we split msg's.
@@ -2834,9 +3196,7 @@ static enum transmit_result transmit_udp(conn *c) {
     // NOTE: uses system sendmsg since we have no support for indirect UDP.
     res = sendmsg(c->sfd, &msg, 0);
     if (res >= 0) {
-        pthread_mutex_lock(&c->thread->stats.mutex);
-        c->thread->stats.bytes_written += res;
-        pthread_mutex_unlock(&c->thread->stats.mutex);
+        THR_STATS_ADD(c->thread, bytes_written, res);
 
         // Ignore the header size from forwarding the IOV's
         res -= UDP_HEADER_SIZE;
@@ -2907,7 +3267,7 @@ static int read_into_chunked_item(conn *c) {
             int tocopy = c->rbytes > c->rlbytes ? c->rlbytes : c->rbytes;
             tocopy = tocopy > unused ? unused : tocopy;
             if (c->ritem != c->rcurr) {
-                memmove(ch->data + ch->used, c->rcurr, tocopy);
+                memcpy(ch->data + ch->used, c->rcurr, tocopy);
             }
             total += tocopy;
             c->rlbytes -= tocopy;
@@ -2922,9 +3282,7 @@ static int read_into_chunked_item(conn *c) {
             res = c->read(c, ch->data + ch->used,
                     (unused > c->rlbytes ? c->rlbytes : unused));
             if (res > 0) {
-                pthread_mutex_lock(&c->thread->stats.mutex);
-                c->thread->stats.bytes_read += res;
-                pthread_mutex_unlock(&c->thread->stats.mutex);
+                THR_STATS_ADD(c->thread, bytes_read, res);
                 ch->used += res;
                 total += res;
                 c->rlbytes -= res;
@@ -3015,9 +3373,7 @@ static void drive_machine(conn *c) {
             if (settings.maxconns_fast) {
                 reject = sfd >= settings.maxconns - 1;
                 if (reject) {
-                    STATS_LOCK();
-                    stats.rejected_conns++;
-                    STATS_UNLOCK();
+                    GLOBAL_STATS_INCR(stats.rejected_conns);
                 }
             } else {
                 reject = false;
@@ -3064,6 +3420,9 @@ static void drive_machine(conn *c) {
                     conn_set_state(c, conn_closing);
                     break;
                 }
+                /* warm the line the incoming bytes land on before the
+                 * syscall's copy_to_user writes into it */
+                __builtin_prefetch(c->rcurr + c->rbytes, 1, 1);
                 res = try_read_network(c);
             } else {
                 // UDP connections always have a static buffer.
@@ -3151,7 +3510,9 @@ static void drive_machine(conn *c) {
                 /* first check if we have leftovers in the conn_read buffer */
                 if (c->rbytes > 0) {
                     int tocopy = c->rbytes > c->rlbytes ? c->rlbytes : c->rbytes;
-                    memmove(c->ritem, c->rcurr, tocopy);
+                    /* ritem points into item memory, never into rbuf, so the
+                     * regions can't overlap. */
+                    memcpy(c->ritem, c->rcurr, tocopy);
                     c->ritem += tocopy;
                     c->rlbytes -= tocopy;
                     c->rcurr += tocopy;
@@ -3164,9 +3525,7 @@ static void drive_machine(conn *c) {
                 /*  now try reading from the socket */
                 res = c->read(c, c->ritem, c->rlbytes);
                 if (res > 0) {
-                    pthread_mutex_lock(&c->thread->stats.mutex);
-                    c->thread->stats.bytes_read += res;
-                    pthread_mutex_unlock(&c->thread->stats.mutex);
+                    THR_STATS_ADD(c->thread, bytes_read, res);
                     if (c->rcurr == c->ritem) {
                         c->rcurr += res;
                     }
@@ -3240,9 +3599,7 @@ static void drive_machine(conn *c) {
             /*  now try reading from the socket */
             res = c->read(c, c->rbuf, c->rsize > c->sbytes ? c->sbytes : c->rsize);
             if (res > 0) {
-                pthread_mutex_lock(&c->thread->stats.mutex);
-                c->thread->stats.bytes_read += res;
-                pthread_mutex_unlock(&c->thread->stats.mutex);
+                THR_STATS_ADD(c->thread, bytes_read, res);
                 c->sbytes -= res;
                 break;
             }
@@ -3377,6 +3734,13 @@ void event_handler(const evutil_socket_t fd, const short which, void *arg) {
 
 static int new_socket(struct addrinfo *ai) {
     int sfd;
+#ifdef SOCK_NONBLOCK
+    /* Ask for the non-blocking flag at creation and skip the fcntl pair. */
+    if ((sfd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK,
+                      ai->ai_protocol)) == -1) {
+        return -1;
+    }
+#else
     int flags;
 
     if ((sfd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol)) == -1) {
@@ -3389,6 +3753,7 @@ static int new_socket(struct addrinfo *ai) {
         close(sfd);
         return -1;
     }
+#endif
     return sfd;
 }
 
@@ -3413,6 +3778,27 @@ static void maximize_sndbuf(const int sfd) {
         return;
     }
 
+    /* On Linux the ceiling is published directly; one read (cached across
+     * listeners) and one setsockopt replace the binary search below. */
+    static int wmem_max = -1;   /* -1: unprobed, 0: unavailable */
+    if (wmem_max == -1) {
+        wmem_max = 0;
+        FILE *f = fopen("/proc/sys/net/core/wmem_max", "r");
+        if (f != NULL) {
+            if (fscanf(f, "%d", &wmem_max) != 1 || wmem_max < 0)
+                wmem_max = 0;
+            fclose(f);
+        }
+    }
+    if (wmem_max > 0) {
+        int size = wmem_max < MAX_SENDBUF_SIZE ? wmem_max : MAX_SENDBUF_SIZE;
+        if (setsockopt(sfd, SOL_SOCKET, SO_SNDBUF, (void *)&size, intsize) == 0) {
+            if (settings.verbose > 1)
+                fprintf(stderr, "<%d send buffer was %d, now %d\n", sfd, old_size, size);
+            return;
+        }
+    }
+
     /* Binary-search for the real maximum. */
     min = old_size;
     max = MAX_SENDBUF_SIZE;
@@ -3608,8 +3994,7 @@ static int server_socket(const char *interface,
 #else
             assert(ssl_enabled == false);
 #endif
-            listen_conn_add->next = listen_conn;
-            listen_conn = listen_conn_add;
+            listen_conn_append(listen_conn_add);
         }
     }
 
@@ -3805,6 +4190,12 @@ static int server_sockets(int port, enum network_transport transport,
 #ifndef DISABLE_UNIX_SOCKET
 static int new_socket_unix(void) {
     int sfd;
+#ifdef SOCK_NONBLOCK
+    if ((sfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0)) == -1) {
+        perror("socket()");
+        return -1;
+    }
+#else
     int flags;
 
     if ((sfd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
@@ -3818,6 +4209,7 @@ static int new_socket_unix(void) {
         close(sfd);
         return -1;
     }
+#endif
     return sfd;
 }
 
@@ -3871,12 +4263,14 @@ static int server_socket_unix(const char *path, int access_mask) {
         close(sfd);
         return 1;
     }
-    if (!(listen_conn = conn_new(sfd, conn_listening,
-                                 EV_READ | EV_PERSIST, 1,
-                                 local_transport, main_base, NULL, 0, settings.binding_protocol))) {
+    conn *listen_conn_add;
+    if (!(listen_conn_add = conn_new(sfd, conn_listening,
+                                     EV_READ | EV_PERSIST, 1,
+                                     local_transport, main_base, NULL, 0, settings.binding_protocol))) {
         fprintf(stderr, "failed to create listening connection\n");
         exit(EXIT_FAILURE);
     }
+    listen_conn_append(listen_conn_add);
 
     return 0;
 }
@@ -3892,7 +4286,7 @@ static int server_socket_unix(const char *path, int access_mask) {
  * rather than absolute UNIX timestamps, a space savings on systems where
  * sizeof(time_t) > sizeof(unsigned int).
  */
-volatile rel_time_t current_time;
+rel_time_t current_time;
 static struct event clockevent;
 #ifdef MEMCACHED_DEBUG
 volatile bool is_paused;
@@ -3907,6 +4301,17 @@ static int64_t monotonic_start;
  * from jitter, simply ticking our internal timer here is accurate enough.
  * Note that users who are setting explicit dates for expiration times *must*
  * ensure their clocks are correct before starting memcached. */
+
+/* Sole writer of current_time; the relaxed store pairs with the plain
+ * loads spread throughout the workers. */
+static void clock_store_current_time(const rel_time_t t) {
+#ifdef __ATOMIC_RELAXED
+    __atomic_store_n(&current_time, t, __ATOMIC_RELAXED);
+#else
+    current_time = t;
+#endif
+}
+
 static void clock_handler(const evutil_socket_t fd, const short which, void *arg) {
     struct timeval t = {.tv_sec = 1, .tv_usec = 0};
     static bool initialized = false;
@@ -3945,12 +4350,20 @@ static void clock_handler(const evutil_socket_t fd, const short which, void *arg
 #if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
     if (monotonic) {
         struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+        /* Jiffy resolution is plenty for a once-a-second tick and the
+         * coarse clock skips the hardware counter read in the vDSO. */
+        if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == -1 &&
+            clock_gettime(CLOCK_MONOTONIC, &ts) == -1)
+            return;
+#else
         if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1)
             return;
+#endif
 #ifdef MEMCACHED_DEBUG
-        current_time = (rel_time_t) (ts.tv_sec - monotonic_start + delta);
+        clock_store_current_time((rel_time_t) (ts.tv_sec - monotonic_start + delta));
 #else
-        current_time = (rel_time_t) (ts.tv_sec - monotonic_start);
+        clock_store_current_time((rel_time_t) (ts.tv_sec - monotonic_start));
 #endif
         return;
     }
@@ -3959,9 +4372,9 @@ static void clock_handler(const evutil_socket_t fd, const short which, void *arg
         struct timeval tv;
         gettimeofday(&tv, NULL);
 #ifdef MEMCACHED_DEBUG
-        current_time = (rel_time_t) (tv.tv_sec - process_started + delta);
+        clock_store_current_time((rel_time_t) (tv.tv_sec - process_started + delta));
 #else
-        current_time = (rel_time_t) (tv.tv_sec - process_started);
+        clock_store_current_time((rel_time_t) (tv.tv_sec - process_started));
 #endif
     }
 }
@@ -3978,7 +4391,7 @@ void verify_default(const char* param, bool condition) {
     }
 }
 
-static void usage(void) {
+static COLD_FUNC void usage(void) {
     printf(PACKAGE " " VERSION "\n");
     printf("-p, --port=<num>          TCP port to listen on (default: %d)\n"
            "-U, --udp-port=<num>      UDP port to listen on (default: %d, off)\n",
@@ -4063,6 +4476,8 @@ static void usage(void) {
            "                          default is %u (unlimited)\n",
            flag_enabled_disabled(settings.maxconns_fast), settings.hashpower_init,
            settings.lru_crawler_sleep, settings.lru_crawler_tocrawl);
+    printf("   - worker_cpu_affinity: pin worker threads round-robin onto CPUs.\n"
+           "                          only useful when workers roughly match core count.\n");
     printf("   - read_buf_mem_limit:  limit in megabytes for connection read/response buffers.\n"
            "                          do not adjust unless you have high (20k+) conn. limits.\n"
            "                          0 means unlimited (default: %u)\n",
@@ -4148,7 +4563,7 @@ static void usage(void) {
     return;
 }
 
-static void usage_license(void) {
+static COLD_FUNC void usage_license(void) {
     printf(PACKAGE " " VERSION "\n\n");
     printf(
     "Copyright (c) 2003, Danga Interactive, Inc. <http://www.danga.com/>\n"
@@ -4247,6 +4662,24 @@ static void sig_usrhandler(const int sig) {
     stop_main_loop = GRACE_STOP;
 }
 
+/* The raw handlers above may run on a worker thread, leaving the main loop
+ * asleep in epoll until the next timer tick. Routing the stop signals
+ * through libevent wakes it immediately, so shutdown latency is bounded by
+ * callback dispatch rather than the one-second clock. */
+static struct event sigint_event;
+static struct event sigterm_event;
+static struct event sigusr1_event;
+
+static void sig_stop_event_handler(const evutil_socket_t sig, const short which, void *arg) {
+    stop_main_loop = (sig == SIGUSR1) ? GRACE_STOP : EXIT_NORMALLY;
+}
+
+static void sig_stop_event_register(struct event *ev, int sig) {
+    evsignal_set(ev, sig, sig_stop_event_handler, NULL);
+    event_base_set(main_base, ev);
+    evsignal_add(ev, NULL);
+}
+
 /*
  * On systems that supports multiple page sizes we may reduce the
  * number of TLB-misses by using the biggest available page size
@@ -4765,6 +5198,7 @@ int main (int argc, char **argv) {
         PROXY_URING,
         PROXY_MEMPROFILE,
 #endif
+        WORKER_CPU_AFFINITY,
 #ifdef MEMCACHED_DEBUG
         RELAXED_PRIVILEGES,
 #endif
@@ -4829,6 +5263,7 @@ int main (int argc, char **argv) {
         [PROXY_URING] = "proxy_uring",
         [PROXY_MEMPROFILE] = "proxy_memprofile",
 #endif
+        [WORKER_CPU_AFFINITY] = "worker_cpu_affinity",
 #ifdef MEMCACHED_DEBUG
         [RELAXED_PRIVILEGES] = "relaxed_privileges",
 #endif
@@ -4978,14 +5413,26 @@ int main (int argc, char **argv) {
             exit(EX_USAGE);
 #endif /* #ifndef DISABLE_UNIX_SOCKET */
             break;
-        case 'U':
-            settings.udpport = atoi(optarg);
+        case 'U': {
+            uint32_t uport;
+            if (!safe_strtoul(optarg, &uport) || uport > 65535) {
+                fprintf(stderr, "Invalid UDP port: %s\n", optarg);
+                return 1;
+            }
+            settings.udpport = uport;
             udp_specified = true;
             break;
-        case 'p':
-            settings.port = atoi(optarg);
+        }
+        case 'p': {
+            uint32_t tport;
+            if (!safe_strtoul(optarg, &tport) || tport > 65535) {
+                fprintf(stderr, "Invalid TCP port: %s\n", optarg);
+                return 1;
+            }
+            settings.port = tport;
             tcp_specified = true;
             break;
+        }
         case 's':
 #ifndef DISABLE_UNIX_SOCKET
             settings.socketpath = optarg;
@@ -4994,9 +5441,18 @@ int main (int argc, char **argv) {
             exit(EX_USAGE);
 #endif /* #ifndef DISABLE_UNIX_SOCKET */
             break;
-        case 'm':
-            settings.maxbytes = ((size_t)atoi(optarg)) * 1024 * 1024;
+        case 'm': {
+            uint64_t mbytes;
+            // atoi silently wrapped junk or oversized limits to garbage;
+            // parse checked and refuse anything that overflows size_t.
+            if (!safe_strtoull(optarg, &mbytes) || mbytes == 0 ||
+                mbytes > (SIZE_MAX >> 20)) {
+                fprintf(stderr, "Invalid memory limit: %s\n", optarg);
+                return 1;
+            }
+            settings.maxbytes = (size_t)mbytes << 20;
             break;
+        }
         case 'M':
             settings.evict_to_free = 0;
             break;
@@ -5116,6 +5572,10 @@ int main (int argc, char **argv) {
             break;
         case 'b' :
             settings.backlog = atoi(optarg);
+            if (settings.backlog <= 0) {
+                fprintf(stderr, "Listen backlog must be greater than 0\n");
+                return 1;
+            }
             break;
         case 'B':
             protocol_specified = true;
@@ -5582,6 +6042,9 @@ int main (int argc, char **argv) {
                 settings.proxy_memprofile = true;
                 break;
 #endif
+            case WORKER_CPU_AFFINITY:
+                settings.worker_cpu_affinity = true;
+                break;
 #ifdef MEMCACHED_DEBUG
             case RELAXED_PRIVILEGES:
                 settings.relaxed_privileges = true;
@@ -5880,6 +6343,12 @@ int main (int argc, char **argv) {
     main_base = event_init();
 #endif
 
+    /* Take over the stop signals now that the event base exists; the plain
+     * handlers installed earlier only cover the startup window. */
+    sig_stop_event_register(&sigint_event, SIGINT);
+    sig_stop_event_register(&sigterm_event, SIGTERM);
+    sig_stop_event_register(&sigusr1_event, SIGUSR1);
+
     /* Load initial auth file if required */
     if (settings.auth_file) {
         if (settings.udpport) {
@@ -5919,6 +6388,14 @@ int main (int argc, char **argv) {
     bool reuse_mem = false;
     void *mem_base = NULL;
     bool prefill = false;
+    // -L on a small cache pins scarce huge pages for little TLB relief;
+    // skip the pool preallocation below this size and keep normal paging.
+    if (preallocate && settings.memory_file == NULL &&
+        settings.maxbytes < 256 * 1024 * 1024) {
+        fprintf(stderr, "Warning: skipping large page preallocation for a"
+                " cache under 256MB.\n");
+        preallocate = false;
+    }
     if (settings.memory_file != NULL) {
         preallocate = true;
         // Easier to manage memory if we prefill the global pool when reusing.
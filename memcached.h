@@ -80,8 +80,18 @@
 #define UDP_MAX_PAYLOAD_SIZE 1400
 #define UDP_HEADER_SIZE 8
 #define UDP_DATA_SIZE 1392 // UDP_MAX_PAYLOAD_SIZE - UDP_HEADER_SIZE
+/* opaque inbound UDP datagram batch; see memcached.c */
+struct conn_udp_rx;
 #define MAX_SENDBUF_SIZE (256 * 1024 * 1024)
 
+/* Pad/align frequently written shared data to its own cache line so it
+ * doesn't false-share with neighboring globals. */
+#if defined(__GNUC__) || defined(__clang__)
+#define CACHELINE_ALIGNED __attribute__((aligned(64)))
+#else
+#define CACHELINE_ALIGNED
+#endif
+
 /* Binary protocol stuff */
 #define BIN_MAX_EXTLEN 20 // length of the _incr command is currently the longest.
 
@@ -93,9 +103,11 @@
 #ifdef LARGE_CLIENT_FLAGS
 typedef uint64_t client_flags_t;
 #define safe_strtoflags safe_strtoull
+#define safe_strtoflags_len safe_strtoull_len
 #else
 typedef uint32_t client_flags_t;
 #define safe_strtoflags safe_strtoul
+#define safe_strtoflags_len safe_strtoul_len
 #endif
 
 /*
@@ -154,9 +166,11 @@ typedef uint32_t client_flags_t;
 #define STAT_KEY_LEN 128
 #define STAT_VAL_LEN 128
 
-/** Append a simple stat with a stat name, value format and value */
+/** Append a simple stat with a stat name, value format and value.
+    strlen() folds to a constant for literal names; array names measure at
+    runtime as before. */
 #define APPEND_STAT(name, fmt, val) \
-    append_stat(name, add_stats, c, fmt, val);
+    append_stat(name, strlen(name), add_stats, c, fmt, val);
 
 /** Append an indexed stat with a stat name (with format), value format
     and value */
@@ -388,9 +402,12 @@ struct thread_stats {
  * Global stats. Only resettable stats should go into this structure.
  */
 struct stats {
-    uint64_t      total_items;
-    uint64_t      total_conns;
+    /* accept/close path counters, bumped lock-free via GLOBAL_STATS_INCR;
+     * keep them off the line the mutex-guarded counters live on. */
+    uint64_t      total_conns CACHELINE_ALIGNED;
     uint64_t      rejected_conns;
+    /* STATS_LOCK guarded counters. */
+    uint64_t      total_items CACHELINE_ALIGNED;
     uint64_t      malloc_fails;
     uint64_t      listen_disabled_num;
     uint64_t      slabs_moved;       /* times slabs were moved around */
@@ -431,7 +448,9 @@ struct stats {
 struct stats_state {
     uint64_t      curr_items;
     uint64_t      curr_bytes;
-    uint64_t      curr_conns;
+    /* bumped with atomics on accept/close; isolated from the mutex-guarded
+     * item counters above. */
+    uint64_t      curr_conns CACHELINE_ALIGNED;
     uint64_t      hash_bytes;       /* size used for hash tables */
     float         extstore_memory_pressure; /* when extstore might memory evict */
     unsigned int  conn_structs;
@@ -479,6 +498,7 @@ struct settings {
     volatile sig_atomic_t sig_hup;  /* a HUP signal was received but not yet handled */
     bool sasl;              /* SASL on/off */
     bool maxconns_fast;     /* Whether or not to early close connections */
+    bool worker_cpu_affinity; /* pin worker threads round-robin onto CPUs */
     bool lru_crawler;        /* Whether or not to enable the autocrawler thread */
     bool lru_maintainer_thread; /* LRU maintainer background thread */
     bool lru_segmented;     /* Use split or flat LRU's */
@@ -725,7 +745,11 @@ typedef struct {
     int cur_sfd;                /* client fd for logging commands */
     int thread_baseid;          /* which "number" thread this is for data offsets */
     int conns_tosubmit;         /* number of conns which have put data in io_queue */
-    struct thread_stats stats;  /* Stats generated by this thread */
+    /* Stats generated by this thread. Cacheline aligned so the hot
+     * single-writer counters of adjacent workers in the threads array never
+     * land on the same line; the aligned type below rounds the struct size
+     * up to a line multiple to cover the tail as well. */
+    struct thread_stats stats CACHELINE_ALIGNED;
     io_queue_t io_queues[IO_QUEUE_COUNT];
     struct conn_queue *ev_queue; /* Worker/conn event queue */
     cache_t *rbuf_cache;        /* static-sized read buffers */
@@ -760,7 +784,7 @@ typedef struct {
     uint32_t proxy_rng[4]; // fast per-thread rng for lua.
     // TODO: add ctx object so we can attach to queue.
 #endif
-} LIBEVENT_THREAD;
+} CACHELINE_ALIGNED LIBEVENT_THREAD;
 
 /**
  * Response objects
@@ -786,6 +810,7 @@ typedef struct _mc_resp {
     bool skip;
     bool suspended; // waiting for response from subsystem
     bool free; // double free detection.
+    bool wf_keep; // write_and_free borrows the conn's stats buffer: don't free.
 #ifdef PROXY
     bool proxy_res; // we're handling a proxied response buffer.
 #endif
@@ -828,24 +853,11 @@ struct _io_pending_t {
  * The structure representing a connection into memcached.
  */
 struct conn {
-    sasl_conn_t *sasl_conn;
+    /* Fields touched by the event loop and the per-command parse/emit
+     * paths live up front so they share the leading cache lines; admin,
+     * UDP, TLS and SASL state trails behind. */
     int    sfd;
-    bool sasl_started;
-    bool authenticated;
-    bool set_stale;
-    bool mset_res; /** uses mset format for return code */
-    bool close_after_write; /** flush write then move to close connection */
-    bool rbuf_malloced; /** read buffer was malloc'ed for ascii mget, needs free() */
-    bool item_malloced; /** item for conn_nread state is a temporary malloc */
-    uint8_t ssl_enabled;
-    void    *ssl;
-#ifdef TLS
-    char   *ssl_wbuf;
-#endif
     enum conn_states  state;
-    enum bin_substates substate;
-    rel_time_t last_cmd_time;
-    struct event event;
     short  ev_flags;
     short  which;   /** which events were just triggered */
 
@@ -856,6 +868,12 @@ struct conn {
 
     mc_resp *resp; // tail response.
     mc_resp *resp_head; // first response in current stack.
+    LIBEVENT_THREAD *thread; /* Pointer to the thread object serving this connection */
+    int (*try_read_command)(conn *c); /* pointer for top level input parser */
+    ssize_t (*read)(conn  *c, void *buf, size_t count);
+    ssize_t (*sendmsg)(conn *c, struct msghdr *msg, int flags);
+    ssize_t (*write)(conn *c, void *buf, size_t count);
+
     char   *ritem;  /** when we read in an item's value, it goes here */
     int    rlbytes;
 
@@ -870,6 +888,16 @@ struct conn {
     /* data for the swallow state */
     int    sbytes;    /* how many bytes to swallow */
 
+    short cmd; /* current command being processed */
+    enum protocol protocol;   /* which protocol this connection speaks */
+    enum network_transport transport; /* what transport is used by this connection */
+    enum bin_substates substate;
+    bool   noreply;   /* True if the reply should not be sent. */
+    bool close_after_write; /** flush write then move to close connection */
+    bool rbuf_malloced; /** read buffer was malloc'ed for ascii mget, needs free() */
+    bool item_malloced; /** item for conn_nread state is a temporary malloc */
+    rel_time_t last_cmd_time;
+
     int resps_suspended; /* see notes on io_queue_cb_t */
 #ifdef PROXY
     void *proxy_rctx; /* pointer to active request context */
@@ -877,44 +905,54 @@ struct conn {
 #ifdef EXTSTORE
     unsigned int recache_counter;
 #endif
-    enum protocol protocol;   /* which protocol this connection speaks */
-    enum network_transport transport; /* what transport is used by this connection */
+    struct event event; /* libevent's own state; fat, so keep it after the hot core */
+
+    /* Binary protocol stuff */
+    /* This is where the binary header goes */
+    protocol_binary_request_header binary_header;
+    uint64_t cas; /* the cas to return */
+    uint64_t tag; /* listener stocket tag */
+    int opaque;
+    int keylen;
     enum close_reasons close_reason; /* reason for transition into conn_closing */
 
+    bool sasl_started;
+    bool authenticated;
+    bool set_stale;
+    bool mset_res; /** uses mset format for return code */
+    uint8_t ssl_enabled;
+    sasl_conn_t *sasl_conn;
+    void    *ssl;
+#ifdef TLS
+    char   *ssl_wbuf;
+#endif
+
     /* data for UDP clients */
     int    request_id; /* Incoming UDP request ID, if this is a UDP "connection" */
     struct sockaddr_in6 request_addr; /* udp: Who sent the most recent request */
     socklen_t request_addr_size;
+#ifdef HAVE_RECVMMSG
+    struct conn_udp_rx *udp_rx; /* udp: batch of inbound datagrams */
+#endif
 
-    bool   noreply;   /* True if the reply should not be sent. */
     /* current stats command */
     struct {
         char *buffer;
         size_t size;
         size_t offset;
+        bool inflight; /* buffer is referenced by a queued response */
     } stats;
 
-    /* Binary protocol stuff */
-    /* This is where the binary header goes */
-    protocol_binary_request_header binary_header;
-    uint64_t cas; /* the cas to return */
-    uint64_t tag; /* listener stocket tag */
-    short cmd; /* current command being processed */
-    int opaque;
-    int keylen;
     conn   *next;     /* Used for generating a list of conn structures */
-    LIBEVENT_THREAD *thread; /* Pointer to the thread object serving this connection */
-    int (*try_read_command)(conn *c); /* pointer for top level input parser */
-    ssize_t (*read)(conn  *c, void *buf, size_t count);
-    ssize_t (*sendmsg)(conn *c, struct msghdr *msg, int flags);
-    ssize_t (*write)(conn *c, void *buf, size_t count);
 };
 
 /* array of conn structures, indexed by file descriptor */
 extern conn **conns;
 
-/* current time of day (updated periodically) */
-extern volatile rel_time_t current_time;
+/* current time of day (updated periodically). Written only by the clock
+ * event with a relaxed atomic store; readers use plain loads since any
+ * staleness is bounded by the one-second tick anyway. */
+extern rel_time_t current_time;
 
 #ifdef MEMCACHED_DEBUG
 extern volatile bool is_paused;
@@ -932,6 +970,7 @@ void do_accept_new_conns(const bool do_accept);
 enum delta_result_type do_add_delta(LIBEVENT_THREAD *t, const char *key,
                                     const size_t nkey, const bool incr,
                                     const int64_t delta, char *buf,
+                                    size_t *len_out,
                                     uint64_t *cas, const uint32_t hv,
                                     item **it_ret);
 enum store_item_type do_store_item(item *item, int comm, LIBEVENT_THREAD *t, const uint32_t hv, int *nbytes, uint64_t *cas, const uint64_t cas_in, bool cas_stale);
@@ -993,7 +1032,7 @@ void sidethread_conn_close(conn *c);
 enum delta_result_type add_delta(LIBEVENT_THREAD *t, const char *key,
                                  const size_t nkey, bool incr,
                                  const int64_t delta, char *buf,
-                                 uint64_t *cas);
+                                 size_t *len_out, uint64_t *cas);
 void accept_new_conns(const bool do_accept);
 void  conn_close_idle(conn *c);
 void  conn_close_all(void);
@@ -1019,8 +1058,41 @@ int stop_conn_timeout_thread(void);
 #define refcount_decr(it) --(it->refcount)
 void STATS_LOCK(void);
 void STATS_UNLOCK(void);
+/* Lock-free bump for the global connection counters hit on every
+ * accept/close. Readers (stats output) tolerate racy 64bit loads the same
+ * way the per-thread stats aggregation does. */
+#ifdef HAVE_GCC_ATOMICS
+#define GLOBAL_STATS_INCR(x) __sync_add_and_fetch(&(x), 1)
+#define GLOBAL_STATS_DECR(x) __sync_sub_and_fetch(&(x), 1)
+#else
+#define GLOBAL_STATS_INCR(x) do { STATS_LOCK(); (x)++; STATS_UNLOCK(); } while (0)
+#define GLOBAL_STATS_DECR(x) do { STATS_LOCK(); (x)--; STATS_UNLOCK(); } while (0)
+#endif
 #define THR_STATS_LOCK(t) pthread_mutex_lock(&t->stats.mutex)
 #define THR_STATS_UNLOCK(t) pthread_mutex_unlock(&t->stats.mutex)
+/* Bump a per-thread stat counter. The owning worker is the only writer, so a
+ * relaxed load+store keeps the value untorn for the aggregation reader
+ * without the mutex or a locked RMW. Falls back to the mutex on compilers
+ * without __atomic support. */
+#if defined(HAVE_GCC_ATOMICS) && defined(__ATOMIC_RELAXED)
+#define THR_STATS_BUMP(t, field) \
+    __atomic_store_n(&(t)->stats.field, \
+        __atomic_load_n(&(t)->stats.field, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED)
+#define THR_STATS_ADD(t, field, n) \
+    __atomic_store_n(&(t)->stats.field, \
+        __atomic_load_n(&(t)->stats.field, __ATOMIC_RELAXED) + (n), __ATOMIC_RELAXED)
+#else
+#define THR_STATS_BUMP(t, field) do { \
+    THR_STATS_LOCK(t); \
+    (t)->stats.field++; \
+    THR_STATS_UNLOCK(t); \
+} while (0)
+#define THR_STATS_ADD(t, field, n) do { \
+    THR_STATS_LOCK(t); \
+    (t)->stats.field += (n); \
+    THR_STATS_UNLOCK(t); \
+} while (0)
+#endif
 void threadlocal_stats_reset(void);
 void threadlocal_stats_aggregate(struct thread_stats *stats);
 void slab_stats_aggregate(struct thread_stats *stats, struct slab_stats *out);
@@ -1028,20 +1100,25 @@ void thread_setname(pthread_t thread, const char *name);
 LIBEVENT_THREAD *get_worker_thread(int id);
 
 /* Stat processing functions */
-void append_stat(const char *name, ADD_STAT add_stats, conn *c,
+void append_stat(const char *name, const size_t klen, ADD_STAT add_stats, conn *c,
                  const char *fmt, ...);
 
 enum store_item_type store_item(item *item, int comm, LIBEVENT_THREAD *t, int *nbytes, uint64_t *cas, const uint64_t cas_in, bool cas_stale);
 
 /* Protocol related code */
 void out_string(conn *c, const char *str);
+void out_string_len(conn *c, const char *str, size_t len);
+/* out_string() for string literals: folds the length at compile time. The
+ * empty-string concat rejects non-literal arguments. */
+#define out_lstring(c, s) out_string_len((c), "" s "", sizeof(s) - 1)
 #define REALTIME_MAXDELTA 60*60*24*30
 /* Negative exptimes can underflow and end up immortal. realtime() will
    immediately expire values that are greater than REALTIME_MAXDELTA, but less
    than process_started, so lets aim for that. */
 #define EXPTIME_TO_POSITIVE_TIME(exptime) (exptime < 0) ? \
         REALTIME_MAXDELTA + 1 : exptime
-rel_time_t realtime(const time_t exptime);
+rel_time_t realtime_slow(const time_t exptime);
+/* fast path is inlined at the bottom of this header. */
 item* limited_get(const char *key, size_t nkey, LIBEVENT_THREAD *t, uint32_t exptime, bool should_touch, bool do_update, bool *overflow);
 item* limited_get_locked(const char *key, size_t nkey, LIBEVENT_THREAD *t, bool do_update, uint32_t *hv, bool *overflow);
 // Read/Response object handlers.
@@ -1059,6 +1136,7 @@ void conn_set_state(conn *c, enum conn_states state);
 void out_of_memory(conn *c, char *ascii_error);
 void out_errstring(conn *c, const char *str);
 void write_and_free(conn *c, char *buf, int bytes);
+void write_stats_buf(conn *c);
 void server_stats(ADD_STAT add_stats, void *c);
 void append_stats(const char *key, const uint16_t klen,
                   const char *val, const uint32_t vlen,
@@ -1088,5 +1166,33 @@ extern void drop_worker_privileges(void);
 #define __builtin_expect(x, expected_value) (x)
 #endif
 
+/* No-op cache prefetch hint for compilers without the builtin. */
+#if !defined(__GNUC__)
+#define __builtin_prefetch(addr, ...) ((void)(addr))
+#endif
+
 #define likely(x)       __builtin_expect((x),1)
 #define unlikely(x)     __builtin_expect((x),0)
+
+/* Mark rarely-run functions so the compiler lays them out away from the hot
+ * request paths. */
+#if defined(__GNUC__)
+#define COLD_FUNC __attribute__((cold))
+#else
+#define COLD_FUNC
+#endif
+
+/*
+ * given time value that's either unix time or delta from current unix time,
+ * return unix time. Use the fact that delta can't exceed one month (and real
+ * time value can't be that low). Inlined so every store path skips the call;
+ * the rare absolute-time case tails into realtime_slow().
+ */
+static inline rel_time_t realtime(const time_t exptime) {
+    if (exptime == 0) return 0; /* 0 means never expire */
+
+    if (likely(exptime <= REALTIME_MAXDELTA)) {
+        return (rel_time_t)(exptime + current_time);
+    }
+    return realtime_slow(exptime);
+}
@@ -9,6 +9,17 @@
 #include "storage.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+/* add_bin_header_ok() packs the response header as three 64bit words; keep
+ * the hand-built layout honest against the wire struct. */
+_Static_assert(offsetof(protocol_binary_response_header, response.bodylen) == 8,
+        "binary response header layout changed");
+_Static_assert(offsetof(protocol_binary_response_header, response.cas) == 16,
+        "binary response header layout changed");
 
 /** binprot handlers **/
 static void process_bin_flush(conn *c, char *extbuf);
@@ -25,6 +36,22 @@ static void process_bin_complete_sasl_auth(conn *c);
 
 static void write_bin_miss_response(conn *c, char *key, size_t nkey);
 
+/* Dump the raw packet header before it's converted to host order. Kept
+ * out of line so the hot parse path doesn't carry the dump loop's code
+ * footprint when verbose is off. */
+static COLD_FUNC void dump_binary_header(conn *c) {
+    int ii;
+    const unsigned char *raw = (const unsigned char *)c->rcurr;
+    fprintf(stderr, "<%d Read binary protocol data:", c->sfd);
+    for (ii = 0; ii < (int)sizeof(c->binary_header.bytes); ++ii) {
+        if (ii % 4 == 0) {
+            fprintf(stderr, "\n<%d   ", c->sfd);
+        }
+        fprintf(stderr, " 0x%02x", raw[ii]);
+    }
+    fprintf(stderr, "\n");
+}
+
 void complete_nread_binary(conn *c) {
     assert(c != NULL);
     assert(c->cmd >= 0);
@@ -52,27 +79,29 @@ int try_read_command_binary(conn *c) {
         /* need more data! */
         return 0;
     } else {
-        memcpy(&c->binary_header, c->rcurr, sizeof(c->binary_header));
-        protocol_binary_request_header* req;
-        req = &c->binary_header;
-
-        if (settings.verbose > 1) {
-            /* Dump the packet before we convert it to host order */
-            int ii;
-            fprintf(stderr, "<%d Read binary protocol data:", c->sfd);
-            for (ii = 0; ii < sizeof(req->bytes); ++ii) {
-                if (ii % 4 == 0) {
-                    fprintf(stderr, "\n<%d   ", c->sfd);
-                }
-                fprintf(stderr, " 0x%02x", req->bytes[ii]);
-            }
-            fprintf(stderr, "\n");
+        if (unlikely(settings.verbose > 1)) {
+            dump_binary_header(c);
         }
 
-        c->binary_header = *req;
-        c->binary_header.request.keylen = ntohs(req->request.keylen);
-        c->binary_header.request.bodylen = ntohl(req->request.bodylen);
-        c->binary_header.request.cas = ntohll(req->request.cas);
+#ifdef __SSSE3__
+        /* One shuffle copies the header's first 16 bytes and byte-swaps
+         * keylen and bodylen in the same shot; the remaining multi-byte
+         * field is the cas, which a single bswap load covers. The opaque
+         * is echoed back verbatim so it stays in wire order. */
+        const __m128i hdr_swap = _mm_setr_epi8(0, 1, 3, 2, 4, 5, 6, 7,
+                                               11, 10, 9, 8, 12, 13, 14, 15);
+        __m128i hdr = _mm_loadu_si128((const __m128i *)c->rcurr);
+        _mm_storeu_si128((__m128i *)&c->binary_header,
+                         _mm_shuffle_epi8(hdr, hdr_swap));
+        uint64_t raw_cas;
+        memcpy(&raw_cas, c->rcurr + 16, sizeof(raw_cas));
+        c->binary_header.request.cas = ntohll(raw_cas);
+#else
+        memcpy(&c->binary_header, c->rcurr, sizeof(c->binary_header));
+        c->binary_header.request.keylen = ntohs(c->binary_header.request.keylen);
+        c->binary_header.request.bodylen = ntohl(c->binary_header.request.bodylen);
+        c->binary_header.request.cas = ntohll(c->binary_header.request.cas);
+#endif
 
         if (c->binary_header.request.magic != PROTOCOL_BINARY_REQ) {
             if (settings.verbose) {
@@ -129,6 +158,18 @@ static char* binary_get_key(conn *c) {
     return c->rcurr - (c->binary_header.request.keylen);
 }
 
+static void dump_bin_header(conn *c, protocol_binary_response_header *header) {
+    int ii;
+    fprintf(stderr, ">%d Writing bin response:", c->sfd);
+    for (ii = 0; ii < sizeof(header->bytes); ++ii) {
+        if (ii % 4 == 0) {
+            fprintf(stderr, "\n>%d  ", c->sfd);
+        }
+        fprintf(stderr, " 0x%02x", header->bytes[ii]);
+    }
+    fprintf(stderr, "\n");
+}
+
 static void add_bin_header(conn *c, uint16_t err, uint8_t hdr_len, uint16_t key_len, uint32_t body_len) {
     protocol_binary_response_header* header;
     mc_resp *resp = c->resp;
@@ -151,16 +192,55 @@ static void add_bin_header(conn *c, uint16_t err, uint8_t hdr_len, uint16_t key_
     header->response.opaque = c->opaque;
     header->response.cas = htonll(c->cas);
 
-    if (settings.verbose > 1) {
-        int ii;
-        fprintf(stderr, ">%d Writing bin response:", c->sfd);
-        for (ii = 0; ii < sizeof(header->bytes); ++ii) {
-            if (ii % 4 == 0) {
-                fprintf(stderr, "\n>%d  ", c->sfd);
-            }
-            fprintf(stderr, " 0x%02x", header->bytes[ii]);
-        }
-        fprintf(stderr, "\n");
+    if (unlikely(settings.verbose > 1)) {
+        dump_bin_header(c, header);
+    }
+
+    resp->wbytes = sizeof(header->response);
+    resp_add_iov(resp, resp->wbuf, resp->wbytes);
+}
+
+/* Common-case header: success status and no key echoed back. Writes the
+ * zeroed fields directly so no byte swapping is needed for them. */
+static void add_bin_header_ok(conn *c, uint8_t hdr_len, uint32_t body_len) {
+    protocol_binary_response_header* header;
+    mc_resp *resp = c->resp;
+
+    assert(c);
+
+    resp_reset(resp);
+
+    header = (protocol_binary_response_header *)resp->wbuf;
+
+#ifdef ENDIAN_LITTLE
+    /* Assemble the 24-byte header as three words so it leaves in three
+     * stores instead of a dozen narrow ones. keylen and status are the
+     * zeroed fields that make this variant cheap. */
+    uint64_t w0 = (uint64_t)PROTOCOL_BINARY_RES
+        | ((uint64_t)c->binary_header.request.opcode << 8)
+        | ((uint64_t)hdr_len << 32)
+        | ((uint64_t)PROTOCOL_BINARY_RAW_BYTES << 40);
+    uint64_t w1 = (uint64_t)htonl(body_len) | ((uint64_t)c->opaque << 32);
+    uint64_t w2 = htonll(c->cas);
+    memcpy(resp->wbuf, &w0, 8);
+    memcpy(resp->wbuf + 8, &w1, 8);
+    memcpy(resp->wbuf + 16, &w2, 8);
+#else
+    header->response.magic = (uint8_t)PROTOCOL_BINARY_RES;
+    header->response.opcode = c->binary_header.request.opcode;
+    header->response.keylen = 0;
+
+    header->response.extlen = (uint8_t)hdr_len;
+    header->response.datatype = (uint8_t)PROTOCOL_BINARY_RAW_BYTES;
+    header->response.status = 0;
+
+    header->response.bodylen = htonl(body_len);
+    header->response.opaque = c->opaque;
+    header->response.cas = htonll(c->cas);
+#endif
+
+    if (unlikely(settings.verbose > 1)) {
+        dump_bin_header(c, header);
     }
 
     resp->wbytes = sizeof(header->response);
@@ -213,7 +293,7 @@ void write_bin_error(conn *c, protocol_binary_response_status err,
         }
     }
 
-    if (settings.verbose > 1) {
+    if (unlikely(settings.verbose > 1)) {
         fprintf(stderr, ">%d Writing an error: %s\n", c->sfd, errstr);
     }
 
@@ -231,7 +311,7 @@ void write_bin_error(conn *c, protocol_binary_response_status err,
 }
 
 /* Just write an error message and disconnect the client */
-static void handle_binary_protocol_error(conn *c) {
+static COLD_FUNC void handle_binary_protocol_error(conn *c) {
     write_bin_error(c, PROTOCOL_BINARY_RESPONSE_EINVAL, NULL, 0);
     if (settings.verbose) {
         fprintf(stderr, "Protocol error (opcode %02x), close connection %d\n",
@@ -244,7 +324,11 @@ static void handle_binary_protocol_error(conn *c) {
 static void write_bin_response(conn *c, void *d, int hlen, int keylen, int dlen) {
     if (!c->noreply || c->cmd == PROTOCOL_BINARY_CMD_GET ||
         c->cmd == PROTOCOL_BINARY_CMD_GETK) {
-        add_bin_header(c, 0, hlen, keylen, dlen);
+        if (keylen == 0) {
+            add_bin_header_ok(c, hlen, dlen);
+        } else {
+            add_bin_header(c, 0, hlen, keylen, dlen);
+        }
         mc_resp *resp = c->resp;
         if (dlen > 0) {
             resp_add_iov(resp, d, dlen);
@@ -254,6 +338,47 @@ static void write_bin_response(conn *c, void *d, int hlen, int keylen, int dlen)
     conn_set_state(c, conn_new_cmd);
 }
 
+/* Locale-free replacements for strtoull/snprintf on the incr/decr hot path.
+ * add_delta hands us a NUL terminated decimal string it just produced, so the
+ * parser doesn't need overflow or junk detection. */
+static inline uint64_t bin_parse_u64(const char *p) {
+    uint64_t v = 0;
+    while (*p >= '0' && *p <= '9') {
+        v = v * 10 + (uint64_t)(*p++ - '0');
+    }
+    return v;
+}
+
+static const char u64toa_pairs[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+/* Writes v in decimal plus a NUL into dst (needs INCR_MAX_STORAGE_LEN bytes)
+ * and returns the length, emitting two digits per divide. */
+static inline int u64toa_fast(uint64_t v, char *dst) {
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+    int len;
+    while (v >= 100) {
+        unsigned int r = (unsigned int)(v % 100) * 2;
+        v /= 100;
+        p -= 2;
+        memcpy(p, u64toa_pairs + r, 2);
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, u64toa_pairs + v * 2, 2);
+    } else {
+        *--p = (char)('0' + v);
+    }
+    len = (int)(tmp + sizeof(tmp) - p);
+    memcpy(dst, p, len);
+    dst[len] = '\0';
+    return len;
+}
+
 static void complete_incr_bin(conn *c, char *extbuf) {
     item *it;
     char *key;
@@ -275,13 +400,9 @@ static void complete_incr_bin(conn *c, char *extbuf) {
     key = binary_get_key(c);
     nkey = c->binary_header.request.keylen;
 
-    if (settings.verbose > 1) {
-        int i;
+    if (unlikely(settings.verbose > 1)) {
         fprintf(stderr, "incr ");
-
-        for (i = 0; i < nkey; i++) {
-            fprintf(stderr, "%c", key[i]);
-        }
+        if (fwrite(key, 1, nkey, stderr)) {}
         fprintf(stderr, " %lld, %llu, %d\n",
                 (long long)req->message.body.delta,
                 (long long)req->message.body.initial,
@@ -293,9 +414,9 @@ static void complete_incr_bin(conn *c, char *extbuf) {
     }
     switch(add_delta(c->thread, key, nkey, c->cmd == PROTOCOL_BINARY_CMD_INCREMENT,
                      req->message.body.delta, tmpbuf,
-                     &cas)) {
+                     NULL, &cas)) {
     case OK:
-        rsp->message.body.value = htonll(strtoull(tmpbuf, NULL, 10));
+        rsp->message.body.value = htonll(bin_parse_u64(tmpbuf));
         if (cas) {
             c->cas = cas;
         }
@@ -313,9 +434,7 @@ static void complete_incr_bin(conn *c, char *extbuf) {
             /* Save some room for the response */
             rsp->message.body.value = htonll(req->message.body.initial);
 
-            snprintf(tmpbuf, INCR_MAX_STORAGE_LEN, "%llu",
-                (unsigned long long)req->message.body.initial);
-            int res = strlen(tmpbuf);
+            int res = u64toa_fast(req->message.body.initial, tmpbuf);
             it = item_alloc(key, nkey, 0, realtime(req->message.body.expiration),
                             res + 2);
 
@@ -338,13 +457,11 @@ static void complete_incr_bin(conn *c, char *extbuf) {
                         "SERVER_ERROR Out of memory allocating new item");
             }
         } else {
-            pthread_mutex_lock(&c->thread->stats.mutex);
             if (c->cmd == PROTOCOL_BINARY_CMD_INCREMENT) {
-                c->thread->stats.incr_misses++;
+                THR_STATS_BUMP(c->thread, incr_misses);
             } else {
-                c->thread->stats.decr_misses++;
+                THR_STATS_BUMP(c->thread, decr_misses);
             }
-            pthread_mutex_unlock(&c->thread->stats.mutex);
 
             write_bin_error(c, PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, NULL, 0);
         }
@@ -361,9 +478,7 @@ static void complete_update_bin(conn *c) {
     assert(c != NULL);
 
     item *it = c->item;
-    pthread_mutex_lock(&c->thread->stats.mutex);
-    c->thread->stats.slab_stats[ITEM_clsid(it)].set_cmds++;
-    pthread_mutex_unlock(&c->thread->stats.mutex);
+    THR_STATS_BUMP(c->thread, slab_stats[ITEM_clsid(it)].set_cmds);
 
     /* We don't actually receive the trailing two characters in the bin
      * protocol, so we're going to just set them here */
@@ -387,51 +502,63 @@ static void complete_update_bin(conn *c) {
     c->cas = cas;
 
 #ifdef ENABLE_DTRACE
-    switch (c->cmd) {
-    case NREAD_ADD:
-        MEMCACHED_COMMAND_ADD(c->sfd, ITEM_key(it), it->nkey,
-                              (ret == STORED) ? it->nbytes : -1, cas);
-        break;
-    case NREAD_REPLACE:
-        MEMCACHED_COMMAND_REPLACE(c->sfd, ITEM_key(it), it->nkey,
+    /* Skip the probe dispatch entirely unless a consumer is attached; the
+     * _ENABLED() checks are loads of the USDT semaphores, which is cheaper
+     * than switching and gathering probe arguments on every store. */
+    if (unlikely(MEMCACHED_COMMAND_ADD_ENABLED()
+            || MEMCACHED_COMMAND_REPLACE_ENABLED()
+            || MEMCACHED_COMMAND_APPEND_ENABLED()
+            || MEMCACHED_COMMAND_PREPEND_ENABLED()
+            || MEMCACHED_COMMAND_SET_ENABLED())) {
+        switch (c->cmd) {
+        case NREAD_ADD:
+            MEMCACHED_COMMAND_ADD(c->sfd, ITEM_key(it), it->nkey,
                                   (ret == STORED) ? it->nbytes : -1, cas);
-        break;
-    case NREAD_APPEND:
-        MEMCACHED_COMMAND_APPEND(c->sfd, ITEM_key(it), it->nkey,
-                                 (ret == STORED) ? it->nbytes : -1, cas);
-        break;
-    case NREAD_PREPEND:
-        MEMCACHED_COMMAND_PREPEND(c->sfd, ITEM_key(it), it->nkey,
-                                 (ret == STORED) ? it->nbytes : -1, cas);
-        break;
-    case NREAD_SET:
-        MEMCACHED_COMMAND_SET(c->sfd, ITEM_key(it), it->nkey,
-                              (ret == STORED) ? it->nbytes : -1, cas);
-        break;
+            break;
+        case NREAD_REPLACE:
+            MEMCACHED_COMMAND_REPLACE(c->sfd, ITEM_key(it), it->nkey,
+                                      (ret == STORED) ? it->nbytes : -1, cas);
+            break;
+        case NREAD_APPEND:
+            MEMCACHED_COMMAND_APPEND(c->sfd, ITEM_key(it), it->nkey,
+                                     (ret == STORED) ? it->nbytes : -1, cas);
+            break;
+        case NREAD_PREPEND:
+            MEMCACHED_COMMAND_PREPEND(c->sfd, ITEM_key(it), it->nkey,
+                                     (ret == STORED) ? it->nbytes : -1, cas);
+            break;
+        case NREAD_SET:
+            MEMCACHED_COMMAND_SET(c->sfd, ITEM_key(it), it->nkey,
+                                  (ret == STORED) ? it->nbytes : -1, cas);
+            break;
+        }
     }
 #endif
 
-    switch (ret) {
-    case STORED:
-        /* Stored */
+    /* One load picks the response code for the store result / command pair;
+     * 0 (SUCCESS) means write the normal stored response. The NOT_STORED,
+     * TOO_LARGE and NO_MEMORY rows vary by command: ADD failing means the
+     * key exists, REPLACE failing means it doesn't. */
+#define BSR_NS PROTOCOL_BINARY_RESPONSE_NOT_STORED
+#define BSR_EX PROTOCOL_BINARY_RESPONSE_KEY_EEXISTS
+#define BSR_NF PROTOCOL_BINARY_RESPONSE_KEY_ENOENT
+    static const uint16_t bin_store_resp[6][NREAD_PREPEND + 1] = {
+        /*                 -    ADD     SET    REPLACE  APPEND  PREPEND */
+        [NOT_STORED] = { BSR_NS, BSR_EX, BSR_NS, BSR_NF, BSR_NS, BSR_NS },
+        [STORED]     = { 0 },
+        [EXISTS]     = { BSR_EX, BSR_EX, BSR_EX, BSR_EX, BSR_EX, BSR_EX },
+        [NOT_FOUND]  = { BSR_NF, BSR_NF, BSR_NF, BSR_NF, BSR_NF, BSR_NF },
+        [TOO_LARGE]  = { BSR_NS, BSR_EX, BSR_NS, BSR_NF, BSR_NS, BSR_NS },
+        [NO_MEMORY]  = { BSR_NS, BSR_EX, BSR_NS, BSR_NF, BSR_NS, BSR_NS },
+    };
+#undef BSR_NS
+#undef BSR_EX
+#undef BSR_NF
+    assert(c->cmd >= NREAD_ADD && c->cmd <= NREAD_PREPEND);
+    eno = bin_store_resp[ret][c->cmd];
+    if (eno == PROTOCOL_BINARY_RESPONSE_SUCCESS) {
         write_bin_response(c, NULL, 0, 0, 0);
-        break;
-    case EXISTS:
-        write_bin_error(c, PROTOCOL_BINARY_RESPONSE_KEY_EEXISTS, NULL, 0);
-        break;
-    case NOT_FOUND:
-        write_bin_error(c, PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, NULL, 0);
-        break;
-    case NOT_STORED:
-    case TOO_LARGE:
-    case NO_MEMORY:
-        if (c->cmd == NREAD_ADD) {
-            eno = PROTOCOL_BINARY_RESPONSE_KEY_EEXISTS;
-        } else if(c->cmd == NREAD_REPLACE) {
-            eno = PROTOCOL_BINARY_RESPONSE_KEY_ENOENT;
-        } else {
-            eno = PROTOCOL_BINARY_RESPONSE_NOT_STORED;
-        }
+    } else {
         write_bin_error(c, eno, NULL, 0);
     }
 
@@ -467,7 +594,7 @@ static void process_bin_get_or_touch(conn *c, char *extbuf) {
     int should_return_value = (c->cmd != PROTOCOL_BINARY_CMD_TOUCH);
     bool failed = false;
 
-    if (settings.verbose > 1) {
+    if (unlikely(settings.verbose > 1)) {
         fprintf(stderr, "<%d %s ", c->sfd, should_touch ? "TOUCH" : "GET");
         if (fwrite(key, 1, nkey, stderr)) {}
         fputc('\n', stderr);
@@ -485,39 +612,51 @@ static void process_bin_get_or_touch(conn *c, char *extbuf) {
     if (it) {
         /* the length has two unnecessary bytes ("\r\n") */
         uint16_t keylen = 0;
-        uint32_t bodylen = sizeof(rsp->message.body) + (it->nbytes - 2);
-
-        pthread_mutex_lock(&c->thread->stats.mutex);
-        if (should_touch) {
-            c->thread->stats.touch_cmds++;
-            c->thread->stats.slab_stats[ITEM_clsid(it)].touch_hits++;
-        } else {
-            c->thread->stats.get_cmds++;
-            c->thread->stats.lru_hits[it->slabs_clsid]++;
+        /* The value bytes aren't read here, but the writev/TLS flush that
+         * follows conn_mwrite will walk them. Start pulling the first lines
+         * of a cold value now so that latency overlaps the stats bumps and
+         * header construction below. */
+        if ((it->it_flags & ITEM_CHUNKED) == 0) {
+            int span = it->nbytes < 256 ? it->nbytes : 256;
+            for (int off = 0; off < span; off += 64) {
+                __builtin_prefetch(ITEM_data(it) + off, 0, 0);
+            }
         }
-        pthread_mutex_unlock(&c->thread->stats.mutex);
+        /* Read everything the response needs out of the item header in one
+         * contiguous window so its cache lines are touched once, before the
+         * stats bumps and wbuf stores start evicting them. */
+        /* raw clsid for lru_hits; ITEM_clsid() masks the LRU bits off it */
+        uint8_t clsid = it->slabs_clsid;
+        uint64_t cas = ITEM_get_cas(it);
+        int nbytes = it->nbytes;
+        client_flags_t flags;
+        FLAGS_CONV(it, flags);
+        uint32_t bodylen = sizeof(rsp->message.body) + (nbytes - 2);
 
         if (should_touch) {
+            THR_STATS_BUMP(c->thread, touch_cmds);
+            THR_STATS_BUMP(c->thread, slab_stats[ITEM_clsid(it)].touch_hits);
             MEMCACHED_COMMAND_TOUCH(c->sfd, ITEM_key(it), it->nkey,
-                                    it->nbytes, ITEM_get_cas(it));
+                                    nbytes, cas);
         } else {
+            THR_STATS_BUMP(c->thread, get_cmds);
+            THR_STATS_BUMP(c->thread, lru_hits[clsid]);
             MEMCACHED_COMMAND_GET(c->sfd, ITEM_key(it), it->nkey,
-                                  it->nbytes, ITEM_get_cas(it));
+                                  nbytes, cas);
         }
 
         if (c->cmd == PROTOCOL_BINARY_CMD_TOUCH) {
-            bodylen -= it->nbytes - 2;
+            bodylen -= nbytes - 2;
         } else if (should_return_key) {
             bodylen += nkey;
             keylen = nkey;
         }
 
         add_bin_header(c, 0, sizeof(rsp->message.body), keylen, bodylen);
-        rsp->message.header.response.cas = htonll(ITEM_get_cas(it));
+        rsp->message.header.response.cas = htonll(cas);
 
         // add the flags
-        FLAGS_CONV(it, rsp->message.body.flags);
-        rsp->message.body.flags = htonl(rsp->message.body.flags);
+        rsp->message.body.flags = htonl(flags);
         resp_add_iov(c->resp, &rsp->message.body, sizeof(rsp->message.body));
 
         if (should_return_key) {
@@ -529,9 +668,7 @@ static void process_bin_get_or_touch(conn *c, char *extbuf) {
 #ifdef EXTSTORE
             if (it->it_flags & ITEM_HDR) {
                 if (storage_get_item(c, it, c->resp) != 0) {
-                    pthread_mutex_lock(&c->thread->stats.mutex);
-                    c->thread->stats.get_oom_extstore++;
-                    pthread_mutex_unlock(&c->thread->stats.mutex);
+                    THR_STATS_BUMP(c->thread, get_oom_extstore);
 
                     failed = true;
                 }
@@ -571,15 +708,13 @@ static void process_bin_get_or_touch(conn *c, char *extbuf) {
     }
 
     if (failed) {
-        pthread_mutex_lock(&c->thread->stats.mutex);
         if (should_touch) {
-            c->thread->stats.touch_cmds++;
-            c->thread->stats.touch_misses++;
+            THR_STATS_BUMP(c->thread, touch_cmds);
+            THR_STATS_BUMP(c->thread, touch_misses);
         } else {
-            c->thread->stats.get_cmds++;
-            c->thread->stats.get_misses++;
+            THR_STATS_BUMP(c->thread, get_cmds);
+            THR_STATS_BUMP(c->thread, get_misses);
         }
-        pthread_mutex_unlock(&c->thread->stats.mutex);
 
         if (should_touch) {
             MEMCACHED_COMMAND_TOUCH(c->sfd, key, nkey, -1, 0);
@@ -598,35 +733,49 @@ static void process_bin_get_or_touch(conn *c, char *extbuf) {
         }
     }
 
-    if (settings.detail_enabled) {
+    if (unlikely(settings.detail_enabled)) {
         stats_prefix_record_get(key, nkey, NULL != it);
     }
 }
 
+/* Compare 4/8 bytes at p against a literal tag with one integer compare;
+ * the compiler folds the tag load into an immediate. Callers must length
+ * check first since the binary stat key is not NUL terminated. */
+static inline bool eq4(const char *p, const char *tag) {
+    uint32_t a, b;
+    memcpy(&a, p, 4);
+    memcpy(&b, tag, 4);
+    return a == b;
+}
+
+static inline bool eq8(const char *p, const char *tag) {
+    uint64_t a, b;
+    memcpy(&a, p, 8);
+    memcpy(&b, tag, 8);
+    return a == b;
+}
+
 static void process_bin_stat(conn *c) {
     char *subcommand = binary_get_key(c);
     size_t nkey = c->binary_header.request.keylen;
 
-    if (settings.verbose > 1) {
-        int ii;
+    if (unlikely(settings.verbose > 1)) {
         fprintf(stderr, "<%d STATS ", c->sfd);
-        for (ii = 0; ii < nkey; ++ii) {
-            fprintf(stderr, "%c", subcommand[ii]);
-        }
-        fprintf(stderr, "\n");
+        if (fwrite(subcommand, 1, nkey, stderr)) {}
+        fputc('\n', stderr);
     }
 
     if (nkey == 0) {
         /* request all statistics */
         server_stats(&append_stats, c);
         (void)get_stats(NULL, 0, &append_stats, c);
-    } else if (strncmp(subcommand, "reset", 5) == 0) {
+    } else if (nkey >= 5 && eq4(subcommand, "rese") && subcommand[4] == 't') {
         stats_reset();
-    } else if (strncmp(subcommand, "settings", 8) == 0) {
+    } else if (nkey >= 8 && eq8(subcommand, "settings")) {
         process_stat_settings(&append_stats, c);
-    } else if (strncmp(subcommand, "detail", 6) == 0) {
+    } else if (nkey >= 6 && eq4(subcommand, "deta") && eq4(subcommand + 2, "tail")) {
         char *subcmd_pos = subcommand + 6;
-        if (strncmp(subcmd_pos, " dump", 5) == 0) {
+        if (nkey >= 11 && eq4(subcmd_pos, " dum") && subcmd_pos[4] == 'p') {
             int len;
             char *dump_buf = stats_prefix_dump(&len);
             if (dump_buf == NULL || len <= 0) {
@@ -638,9 +787,10 @@ static void process_bin_stat(conn *c) {
                 append_stats("detailed", strlen("detailed"), dump_buf, len, c);
                 free(dump_buf);
             }
-        } else if (strncmp(subcmd_pos, " on", 3) == 0) {
+        } else if (nkey >= 9 && subcmd_pos[0] == ' ' && subcmd_pos[1] == 'o'
+                   && subcmd_pos[2] == 'n') {
             settings.detail_enabled = 1;
-        } else if (strncmp(subcmd_pos, " off", 4) == 0) {
+        } else if (nkey >= 10 && eq4(subcmd_pos, " off")) {
             settings.detail_enabled = 0;
         } else {
             write_bin_error(c, PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, NULL, 0);
@@ -651,8 +801,7 @@ static void process_bin_stat(conn *c) {
             if (c->stats.buffer == NULL) {
                 out_of_memory(c, "SERVER_ERROR Out of memory generating stats");
             } else {
-                write_and_free(c, c->stats.buffer, c->stats.offset);
-                c->stats.buffer = NULL;
+                write_stats_buf(c);
             }
         } else {
             write_bin_error(c, PROTOCOL_BINARY_RESPONSE_KEY_ENOENT, NULL, 0);
@@ -666,8 +815,7 @@ static void process_bin_stat(conn *c) {
     if (c->stats.buffer == NULL) {
         out_of_memory(c, "SERVER_ERROR Out of memory preparing to send stats");
     } else {
-        write_and_free(c, c->stats.buffer, c->stats.offset);
-        c->stats.buffer = NULL;
+        write_stats_buf(c);
     }
 }
 
@@ -875,7 +1023,7 @@ static bool authenticated(conn *c) {
         rv = c->authenticated;
     }
 
-    if (settings.verbose > 1) {
+    if (unlikely(settings.verbose > 1)) {
         fprintf(stderr, "authenticated() in cmd 0x%02x is %s\n",
                 c->cmd, rv ? "true" : "false");
     }
@@ -883,9 +1031,117 @@ static bool authenticated(conn *c) {
     return rv;
 }
 
-static void dispatch_bin_command(conn *c, char *extbuf) {
-    int protocol_error = 0;
+/* Quiet opcodes fold onto their non-quiet counterparts before dispatch;
+ * everything else maps to itself. Table lookups replace a 14-way switch on
+ * the hottest path in the binary parser. */
+#define BIN_QUIET(q, nq) [PROTOCOL_BINARY_CMD_##q] = PROTOCOL_BINARY_CMD_##nq
+static const uint8_t bin_cmd_canonical[256] = {
+#define X(n) [n] = n,
+    X(0x00) X(0x01) X(0x02) X(0x03) X(0x04) X(0x05) X(0x06) X(0x07)
+    X(0x08) X(0x09) X(0x0a) X(0x0b) X(0x0c) X(0x0d) X(0x0e) X(0x0f)
+    X(0x10) X(0x11) X(0x12) X(0x13) X(0x14) X(0x15) X(0x16) X(0x17)
+    X(0x18) X(0x19) X(0x1a) X(0x1b) X(0x1c) X(0x1d) X(0x1e) X(0x1f)
+    X(0x20) X(0x21) X(0x22) X(0x23) X(0x24) X(0x25) X(0x26) X(0x27)
+    X(0x28) X(0x29) X(0x2a) X(0x2b) X(0x2c) X(0x2d) X(0x2e) X(0x2f)
+    X(0x30) X(0x31) X(0x32) X(0x33) X(0x34) X(0x35) X(0x36) X(0x37)
+    X(0x38) X(0x39) X(0x3a) X(0x3b) X(0x3c) X(0x3d) X(0x3e) X(0x3f)
+    X(0x40) X(0x41) X(0x42) X(0x43) X(0x44) X(0x45) X(0x46) X(0x47)
+    X(0x48) X(0x49) X(0x4a) X(0x4b) X(0x4c) X(0x4d) X(0x4e) X(0x4f)
+    X(0x50) X(0x51) X(0x52) X(0x53) X(0x54) X(0x55) X(0x56) X(0x57)
+    X(0x58) X(0x59) X(0x5a) X(0x5b) X(0x5c) X(0x5d) X(0x5e) X(0x5f)
+    X(0x60) X(0x61) X(0x62) X(0x63) X(0x64) X(0x65) X(0x66) X(0x67)
+    X(0x68) X(0x69) X(0x6a) X(0x6b) X(0x6c) X(0x6d) X(0x6e) X(0x6f)
+    X(0x70) X(0x71) X(0x72) X(0x73) X(0x74) X(0x75) X(0x76) X(0x77)
+    X(0x78) X(0x79) X(0x7a) X(0x7b) X(0x7c) X(0x7d) X(0x7e) X(0x7f)
+    X(0x80) X(0x81) X(0x82) X(0x83) X(0x84) X(0x85) X(0x86) X(0x87)
+    X(0x88) X(0x89) X(0x8a) X(0x8b) X(0x8c) X(0x8d) X(0x8e) X(0x8f)
+    X(0x90) X(0x91) X(0x92) X(0x93) X(0x94) X(0x95) X(0x96) X(0x97)
+    X(0x98) X(0x99) X(0x9a) X(0x9b) X(0x9c) X(0x9d) X(0x9e) X(0x9f)
+    X(0xa0) X(0xa1) X(0xa2) X(0xa3) X(0xa4) X(0xa5) X(0xa6) X(0xa7)
+    X(0xa8) X(0xa9) X(0xaa) X(0xab) X(0xac) X(0xad) X(0xae) X(0xaf)
+    X(0xb0) X(0xb1) X(0xb2) X(0xb3) X(0xb4) X(0xb5) X(0xb6) X(0xb7)
+    X(0xb8) X(0xb9) X(0xba) X(0xbb) X(0xbc) X(0xbd) X(0xbe) X(0xbf)
+    X(0xc0) X(0xc1) X(0xc2) X(0xc3) X(0xc4) X(0xc5) X(0xc6) X(0xc7)
+    X(0xc8) X(0xc9) X(0xca) X(0xcb) X(0xcc) X(0xcd) X(0xce) X(0xcf)
+    X(0xd0) X(0xd1) X(0xd2) X(0xd3) X(0xd4) X(0xd5) X(0xd6) X(0xd7)
+    X(0xd8) X(0xd9) X(0xda) X(0xdb) X(0xdc) X(0xdd) X(0xde) X(0xdf)
+    X(0xe0) X(0xe1) X(0xe2) X(0xe3) X(0xe4) X(0xe5) X(0xe6) X(0xe7)
+    X(0xe8) X(0xe9) X(0xea) X(0xeb) X(0xec) X(0xed) X(0xee) X(0xef)
+    X(0xf0) X(0xf1) X(0xf2) X(0xf3) X(0xf4) X(0xf5) X(0xf6) X(0xf7)
+    X(0xf8) X(0xf9) X(0xfa) X(0xfb) X(0xfc) X(0xfd) X(0xfe) X(0xff)
+#undef X
+    BIN_QUIET(SETQ, SET),
+    BIN_QUIET(ADDQ, ADD),
+    BIN_QUIET(REPLACEQ, REPLACE),
+    BIN_QUIET(DELETEQ, DELETE),
+    BIN_QUIET(INCREMENTQ, INCREMENT),
+    BIN_QUIET(DECREMENTQ, DECREMENT),
+    BIN_QUIET(QUITQ, QUIT),
+    BIN_QUIET(FLUSHQ, FLUSH),
+    BIN_QUIET(APPENDQ, APPEND),
+    BIN_QUIET(PREPENDQ, PREPEND),
+    BIN_QUIET(GETQ, GET),
+    BIN_QUIET(GETKQ, GETK),
+    BIN_QUIET(GATQ, GAT),
+    BIN_QUIET(GATKQ, GATK),
+};
+#undef BIN_QUIET
+
+static const uint8_t bin_cmd_is_quiet[256] = {
+    [PROTOCOL_BINARY_CMD_SETQ] = 1,
+    [PROTOCOL_BINARY_CMD_ADDQ] = 1,
+    [PROTOCOL_BINARY_CMD_REPLACEQ] = 1,
+    [PROTOCOL_BINARY_CMD_DELETEQ] = 1,
+    [PROTOCOL_BINARY_CMD_INCREMENTQ] = 1,
+    [PROTOCOL_BINARY_CMD_DECREMENTQ] = 1,
+    [PROTOCOL_BINARY_CMD_QUITQ] = 1,
+    [PROTOCOL_BINARY_CMD_FLUSHQ] = 1,
+    [PROTOCOL_BINARY_CMD_APPENDQ] = 1,
+    [PROTOCOL_BINARY_CMD_PREPENDQ] = 1,
+    [PROTOCOL_BINARY_CMD_GETQ] = 1,
+    [PROTOCOL_BINARY_CMD_GETKQ] = 1,
+    [PROTOCOL_BINARY_CMD_GATQ] = 1,
+    [PROTOCOL_BINARY_CMD_GATKQ] = 1,
+};
+
+/* Per-opcode header requirements, indexed by the canonical command.
+ * Validating from one table row keeps the big dispatch switch free of
+ * bespoke length conditionals. Opcodes without a row are unknown. */
+#define BIN_KEY_NONE 0  /* keylen must be 0 */
+#define BIN_KEY_REQ  1  /* keylen must be nonzero */
+#define BIN_KEY_ANY  2
+#define BIN_BODY_EXACT 0 /* bodylen must equal keylen + extlen */
+#define BIN_BODY_ANY   1
+static const struct bin_cmd_spec {
+    uint8_t known;
+    int8_t extlen;   /* required extlen; -1 allows 0 or 4 (flush) */
+    uint8_t keymode;
+    uint8_t bodymode;
+} bin_cmd_spec[256] = {
+    [PROTOCOL_BINARY_CMD_VERSION]   = { 1,  0, BIN_KEY_NONE, BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_FLUSH]     = { 1, -1, BIN_KEY_NONE, BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_NOOP]      = { 1,  0, BIN_KEY_NONE, BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_SET]       = { 1,  8, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_ADD]       = { 1,  8, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_REPLACE]   = { 1,  8, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_GET]       = { 1,  0, BIN_KEY_REQ,  BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_GETK]      = { 1,  0, BIN_KEY_REQ,  BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_DELETE]    = { 1,  0, BIN_KEY_REQ,  BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_INCREMENT] = { 1, 20, BIN_KEY_REQ,  BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_DECREMENT] = { 1, 20, BIN_KEY_REQ,  BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_APPEND]    = { 1,  0, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_PREPEND]   = { 1,  0, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_STAT]      = { 1,  0, BIN_KEY_ANY,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_QUIT]      = { 1,  0, BIN_KEY_NONE, BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_SASL_LIST_MECHS] = { 1, 0, BIN_KEY_NONE, BIN_BODY_EXACT },
+    [PROTOCOL_BINARY_CMD_SASL_AUTH] = { 1,  0, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_SASL_STEP] = { 1,  0, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_TOUCH]     = { 1,  4, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_GAT]       = { 1,  4, BIN_KEY_REQ,  BIN_BODY_ANY },
+    [PROTOCOL_BINARY_CMD_GATK]      = { 1,  4, BIN_KEY_REQ,  BIN_BODY_ANY },
+};
 
+static void dispatch_bin_command(conn *c, char *extbuf) {
     uint8_t extlen = c->binary_header.request.extlen;
     uint16_t keylen = c->binary_header.request.keylen;
     uint32_t bodylen = c->binary_header.request.bodylen;
@@ -904,7 +1160,6 @@ static void dispatch_bin_command(conn *c, char *extbuf) {
     }
 
     MEMCACHED_PROCESS_COMMAND_START(c->sfd, c->rcurr, c->rbytes);
-    c->noreply = true;
 
     /* binprot supports 16bit keys, but internals are still 8bit */
     if (keylen > KEY_MAX_LENGTH) {
@@ -912,169 +1167,81 @@ static void dispatch_bin_command(conn *c, char *extbuf) {
         return;
     }
 
-    switch (c->cmd) {
-    case PROTOCOL_BINARY_CMD_SETQ:
-        c->cmd = PROTOCOL_BINARY_CMD_SET;
-        break;
-    case PROTOCOL_BINARY_CMD_ADDQ:
-        c->cmd = PROTOCOL_BINARY_CMD_ADD;
-        break;
-    case PROTOCOL_BINARY_CMD_REPLACEQ:
-        c->cmd = PROTOCOL_BINARY_CMD_REPLACE;
-        break;
-    case PROTOCOL_BINARY_CMD_DELETEQ:
-        c->cmd = PROTOCOL_BINARY_CMD_DELETE;
-        break;
-    case PROTOCOL_BINARY_CMD_INCREMENTQ:
-        c->cmd = PROTOCOL_BINARY_CMD_INCREMENT;
-        break;
-    case PROTOCOL_BINARY_CMD_DECREMENTQ:
-        c->cmd = PROTOCOL_BINARY_CMD_DECREMENT;
-        break;
-    case PROTOCOL_BINARY_CMD_QUITQ:
-        c->cmd = PROTOCOL_BINARY_CMD_QUIT;
-        break;
-    case PROTOCOL_BINARY_CMD_FLUSHQ:
-        c->cmd = PROTOCOL_BINARY_CMD_FLUSH;
-        break;
-    case PROTOCOL_BINARY_CMD_APPENDQ:
-        c->cmd = PROTOCOL_BINARY_CMD_APPEND;
-        break;
-    case PROTOCOL_BINARY_CMD_PREPENDQ:
-        c->cmd = PROTOCOL_BINARY_CMD_PREPEND;
-        break;
-    case PROTOCOL_BINARY_CMD_GETQ:
-        c->cmd = PROTOCOL_BINARY_CMD_GET;
-        break;
-    case PROTOCOL_BINARY_CMD_GETKQ:
-        c->cmd = PROTOCOL_BINARY_CMD_GETK;
-        break;
-    case PROTOCOL_BINARY_CMD_GATQ:
-        c->cmd = PROTOCOL_BINARY_CMD_GAT;
-        break;
-    case PROTOCOL_BINARY_CMD_GATKQ:
-        c->cmd = PROTOCOL_BINARY_CMD_GATK;
-        break;
-    default:
-        c->noreply = false;
+    c->noreply = bin_cmd_is_quiet[(uint8_t)c->cmd];
+    c->cmd = bin_cmd_canonical[(uint8_t)c->cmd];
+
+    const struct bin_cmd_spec *spec = &bin_cmd_spec[(uint8_t)c->cmd];
+    if (spec->known) {
+        if ((spec->extlen >= 0 ? extlen != spec->extlen
+                               : (extlen != 0 && extlen != 4))
+            || (spec->keymode == BIN_KEY_NONE && keylen != 0)
+            || (spec->keymode == BIN_KEY_REQ && keylen == 0)
+            || (spec->bodymode == BIN_BODY_EXACT
+                && bodylen != (uint32_t)keylen + extlen)) {
+            handle_binary_protocol_error(c);
+            return;
+        }
     }
 
     switch (c->cmd) {
         case PROTOCOL_BINARY_CMD_VERSION:
-            if (extlen == 0 && keylen == 0 && bodylen == 0) {
-                write_bin_response(c, VERSION, 0, 0, strlen(VERSION));
-            } else {
-                protocol_error = 1;
-            }
+            write_bin_response(c, VERSION, 0, 0, strlen(VERSION));
             break;
         case PROTOCOL_BINARY_CMD_FLUSH:
-            if (keylen == 0 && bodylen == extlen && (extlen == 0 || extlen == 4)) {
-                process_bin_flush(c, extbuf);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_flush(c, extbuf);
             break;
         case PROTOCOL_BINARY_CMD_NOOP:
-            if (extlen == 0 && keylen == 0 && bodylen == 0) {
-                write_bin_response(c, NULL, 0, 0, 0);
-                // NOOP forces pipeline flush.
-                conn_set_state(c, conn_mwrite);
-            } else {
-                protocol_error = 1;
-            }
+            write_bin_response(c, NULL, 0, 0, 0);
+            // NOOP forces pipeline flush.
+            conn_set_state(c, conn_mwrite);
             break;
         case PROTOCOL_BINARY_CMD_SET: /* FALLTHROUGH */
         case PROTOCOL_BINARY_CMD_ADD: /* FALLTHROUGH */
         case PROTOCOL_BINARY_CMD_REPLACE:
-            if (extlen == 8 && keylen != 0 && bodylen >= (keylen + 8)) {
-                process_bin_update(c, extbuf);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_update(c, extbuf);
             break;
-        case PROTOCOL_BINARY_CMD_GETQ:  /* FALLTHROUGH */
-        case PROTOCOL_BINARY_CMD_GET:   /* FALLTHROUGH */
-        case PROTOCOL_BINARY_CMD_GETKQ: /* FALLTHROUGH */
+        case PROTOCOL_BINARY_CMD_GET: /* FALLTHROUGH */
         case PROTOCOL_BINARY_CMD_GETK:
-            if (extlen == 0 && bodylen == keylen && keylen > 0) {
-                process_bin_get_or_touch(c, extbuf);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_get_or_touch(c, extbuf);
             break;
         case PROTOCOL_BINARY_CMD_DELETE:
-            if (keylen > 0 && extlen == 0 && bodylen == keylen) {
-                process_bin_delete(c);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_delete(c);
             break;
         case PROTOCOL_BINARY_CMD_INCREMENT:
         case PROTOCOL_BINARY_CMD_DECREMENT:
-            if (keylen > 0 && extlen == 20 && bodylen == (keylen + extlen)) {
-                complete_incr_bin(c, extbuf);
-            } else {
-                protocol_error = 1;
-            }
+            complete_incr_bin(c, extbuf);
             break;
         case PROTOCOL_BINARY_CMD_APPEND:
         case PROTOCOL_BINARY_CMD_PREPEND:
-            if (keylen > 0 && extlen == 0) {
-                process_bin_append_prepend(c);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_append_prepend(c);
             break;
         case PROTOCOL_BINARY_CMD_STAT:
-            if (extlen == 0) {
-                process_bin_stat(c);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_stat(c);
             break;
         case PROTOCOL_BINARY_CMD_QUIT:
-            if (keylen == 0 && extlen == 0 && bodylen == 0) {
-                write_bin_response(c, NULL, 0, 0, 0);
-                conn_set_state(c, conn_mwrite);
-                c->close_after_write = true;
-                c->close_reason = NORMAL_CLOSE;
-            } else {
-                protocol_error = 1;
-            }
+            write_bin_response(c, NULL, 0, 0, 0);
+            conn_set_state(c, conn_mwrite);
+            c->close_after_write = true;
+            c->close_reason = NORMAL_CLOSE;
             break;
         case PROTOCOL_BINARY_CMD_SASL_LIST_MECHS:
-            if (extlen == 0 && keylen == 0 && bodylen == 0) {
-                bin_list_sasl_mechs(c);
-            } else {
-                protocol_error = 1;
-            }
+            bin_list_sasl_mechs(c);
             break;
         case PROTOCOL_BINARY_CMD_SASL_AUTH:
         case PROTOCOL_BINARY_CMD_SASL_STEP:
-            if (extlen == 0 && keylen != 0) {
-                process_bin_sasl_auth(c);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_sasl_auth(c);
             break;
         case PROTOCOL_BINARY_CMD_TOUCH:
         case PROTOCOL_BINARY_CMD_GAT:
         case PROTOCOL_BINARY_CMD_GATQ:
         case PROTOCOL_BINARY_CMD_GATK:
         case PROTOCOL_BINARY_CMD_GATKQ:
-            if (extlen == 4 && keylen != 0) {
-                process_bin_get_or_touch(c, extbuf);
-            } else {
-                protocol_error = 1;
-            }
+            process_bin_get_or_touch(c, extbuf);
             break;
         default:
             write_bin_error(c, PROTOCOL_BINARY_RESPONSE_UNKNOWN_COMMAND, NULL,
                             bodylen);
     }
-
-    if (protocol_error)
-        handle_binary_protocol_error(c);
 }
 
 static void process_bin_update(conn *c, char *extbuf) {
@@ -1095,8 +1262,7 @@ static void process_bin_update(conn *c, char *extbuf) {
 
     vlen = c->binary_header.request.bodylen - (nkey + c->binary_header.request.extlen);
 
-    if (settings.verbose > 1) {
-        int ii;
+    if (unlikely(settings.verbose > 1)) {
         if (c->cmd == PROTOCOL_BINARY_CMD_ADD) {
             fprintf(stderr, "<%d ADD ", c->sfd);
         } else if (c->cmd == PROTOCOL_BINARY_CMD_SET) {
@@ -1104,15 +1270,11 @@ static void process_bin_update(conn *c, char *extbuf) {
         } else {
             fprintf(stderr, "<%d REPLACE ", c->sfd);
         }
-        for (ii = 0; ii < nkey; ++ii) {
-            fprintf(stderr, "%c", key[ii]);
-        }
-
-        fprintf(stderr, " Value len is %d", vlen);
-        fprintf(stderr, "\n");
+        if (fwrite(key, 1, nkey, stderr)) {}
+        fprintf(stderr, " Value len is %d\n", vlen);
     }
 
-    if (settings.detail_enabled) {
+    if (unlikely(settings.detail_enabled)) {
         stats_prefix_record_set(key, nkey);
     }
 
@@ -1138,12 +1300,14 @@ static void process_bin_update(conn *c, char *extbuf) {
         /* Avoid stale data persisting in cache because we failed alloc.
          * Unacceptable for SET. Anywhere else too? */
         if (c->cmd == PROTOCOL_BINARY_CMD_SET) {
-            it = item_get(key, nkey, c->thread, DONT_UPDATE);
+            uint32_t hv;
+            it = item_get_locked(key, nkey, c->thread, DONT_UPDATE, &hv);
             if (it) {
-                item_unlink(it);
+                do_item_unlink(it, hv);
                 STORAGE_delete(c->thread->storage, it);
-                item_remove(it);
+                do_item_remove(it);
             }
+            item_unlock(hv);
         }
 
         /* swallow the data line */
@@ -1198,11 +1362,11 @@ static void process_bin_append_prepend(conn *c) {
     nkey = c->binary_header.request.keylen;
     vlen = c->binary_header.request.bodylen - nkey;
 
-    if (settings.verbose > 1) {
+    if (unlikely(settings.verbose > 1)) {
         fprintf(stderr, "Value len is %d\n", vlen);
     }
 
-    if (settings.detail_enabled) {
+    if (unlikely(settings.detail_enabled)) {
         stats_prefix_record_set(key, nkey);
     }
 
@@ -1287,16 +1451,13 @@ static void process_bin_delete(conn *c) {
     char* key = binary_get_key(c);
     size_t nkey = c->binary_header.request.keylen;
 
-    if (settings.verbose > 1) {
-        int ii;
+    if (unlikely(settings.verbose > 1)) {
         fprintf(stderr, "Deleting ");
-        for (ii = 0; ii < nkey; ++ii) {
-            fprintf(stderr, "%c", key[ii]);
-        }
-        fprintf(stderr, "\n");
+        if (fwrite(key, 1, nkey, stderr)) {}
+        fputc('\n', stderr);
     }
 
-    if (settings.detail_enabled) {
+    if (unlikely(settings.detail_enabled)) {
         stats_prefix_record_delete(key, nkey);
     }
 
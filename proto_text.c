@@ -49,6 +49,18 @@ typedef struct token_s {
     size_t length;
 } token_t;
 
+/* Check for a "\r\n" terminator with one 16bit compare instead of a strncmp
+ * call; this runs once per stored payload. */
+static inline bool ends_crlf(const char *p) {
+    uint16_t tail;
+    memcpy(&tail, p, 2);
+#ifdef ENDIAN_BIG
+    return tail == 0x0D0Au;
+#else
+    return tail == 0x0A0Du;
+#endif
+}
+
 static void _finalize_mset(conn *c, int nbytes, enum store_item_type ret, uint64_t cas) {
     mc_resp *resp = c->resp;
     item *it = c->item;
@@ -143,7 +155,7 @@ void complete_nread_ascii(conn *c) {
     pthread_mutex_unlock(&c->thread->stats.mutex);
 
     if ((it->it_flags & ITEM_CHUNKED) == 0) {
-        if (strncmp(ITEM_data(it) + it->nbytes - 2, "\r\n", 2) == 0) {
+        if (ends_crlf(ITEM_data(it) + it->nbytes - 2)) {
             is_valid = true;
         }
     } else {
@@ -163,7 +175,7 @@ void complete_nread_ascii(conn *c) {
             buf[0] = ch->prev->data[ch->prev->used - 1];
             buf[1] = ch->data[ch->used - 1];
         }
-        if (strncmp(buf, "\r\n", 2) == 0) {
+        if (ends_crlf(buf)) {
             is_valid = true;
         } else {
             assert(1 == 0);
@@ -216,19 +228,19 @@ void complete_nread_ascii(conn *c) {
       } else {
           switch (ret) {
           case STORED:
-              out_string(c, "STORED");
+              out_lstring(c, "STORED");
               break;
           case EXISTS:
-              out_string(c, "EXISTS");
+              out_lstring(c, "EXISTS");
               break;
           case NOT_FOUND:
-              out_string(c, "NOT_FOUND");
+              out_lstring(c, "NOT_FOUND");
               break;
           case NOT_STORED:
-              out_string(c, "NOT_STORED");
+              out_lstring(c, "NOT_STORED");
               break;
           default:
-              out_string(c, "SERVER_ERROR Unhandled storage type.");
+              out_lstring(c, "SERVER_ERROR Unhandled storage type.");
           }
       }
 
@@ -270,6 +282,12 @@ void complete_nread_ascii(conn *c) {
         } \
     } while (0)
 
+/* Match the command token against a literal with a length check plus a
+ * constant-size memcmp the compiler folds into one or two word compares,
+ * instead of a byte-scanning strcmp per candidate. */
+#define CMD_EQ(t, lit) (((t)->length == sizeof(lit) - 1) && \
+        memcmp((t)->value, (lit), sizeof(lit) - 1) == 0)
+
 /*
  * Tokenize the command string by replacing whitespace with '\0' and update
  * the token array tokens with pointer to start of each token and length.
@@ -287,47 +305,121 @@ void complete_nread_ascii(conn *c) {
  *      command  = tokens[ix].value;
  *   }
  */
+/* Find the next ' ' or '\0' at or after p, a word at a time. */
+static inline char *scan_spc_nul(char *p) {
+#if defined(__GNUC__) || defined(__clang__)
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    const uint64_t spaces = ones * ' ';
+    /* Walk to an 8 byte boundary first: aligned loads may overread past the
+     * terminator but cannot cross a page, so the wide loop stays safe. */
+    while (((uintptr_t)p & 7) != 0) {
+        if (*p == ' ' || *p == '\0')
+            return p;
+        p++;
+    }
+    for (;;) {
+        uint64_t x;
+        uint64_t m;
+        memcpy(&x, p, 8);
+        /* 0x80 lands in each byte that is NUL before/after the space xor */
+        m = ((x - ones) & ~x) | (((x ^ spaces) - ones) & ~(x ^ spaces));
+        m &= highs;
+        if (m != 0) {
+#ifdef ENDIAN_BIG
+            return p + (__builtin_clzll(m) >> 3);
+#else
+            return p + (__builtin_ctzll(m) >> 3);
+#endif
+        }
+        p += 8;
+    }
+#else
+    while (*p != ' ' && *p != '\0')
+        p++;
+    return p;
+#endif
+}
+
+/* Find the first '\n' in the n bytes at p, a word at a time; NULL if absent.
+ * Companion to scan_spc_nul for the unterminated read buffer, so the length
+ * is bounded explicitly: byte loop to an 8 byte boundary, then aligned loads
+ * (which may overread within the word but cannot cross a page), then a byte
+ * tail. Beats the memchr call setup for the short commands that dominate. */
+static inline char *scan_lf(char *p, size_t n) {
+#if defined(__GNUC__) || defined(__clang__)
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    const uint64_t lfs = ones * '\n';
+    char *end = p + n;
+    while (((uintptr_t)p & 7) != 0 && p < end) {
+        if (*p == '\n')
+            return p;
+        p++;
+    }
+    while (end - p >= 8) {
+        uint64_t x;
+        uint64_t m;
+        memcpy(&x, p, 8);
+        m = (((x ^ lfs) - ones) & ~(x ^ lfs)) & highs;
+        if (m != 0) {
+#ifdef ENDIAN_BIG
+            return p + (__builtin_clzll(m) >> 3);
+#else
+            return p + (__builtin_ctzll(m) >> 3);
+#endif
+        }
+        p += 8;
+    }
+    while (p < end) {
+        if (*p == '\n')
+            return p;
+        p++;
+    }
+    return NULL;
+#else
+    return memchr(p, '\n', n);
+#endif
+}
+
 static size_t tokenize_command(char *command, token_t *tokens, const size_t max_tokens) {
-    char *s, *e;
+    char *s = command;
     size_t ntokens = 0;
     assert(command != NULL && tokens != NULL && max_tokens > 1);
-    size_t len = strlen(command);
-    unsigned int i = 0;
 
-    s = e = command;
-    for (i = 0; i < len; i++) {
-        if (*e == ' ') {
+    for (;;) {
+        char *e = scan_spc_nul(s);
+        /* skip over runs of spaces without emitting empty tokens */
+        while (*e == ' ' && s == e) {
+            s = e + 1;
+            e = scan_spc_nul(s);
+        }
+
+        if (*e == '\0') {
             if (s != e) {
                 tokens[ntokens].value = s;
                 tokens[ntokens].length = e - s;
                 ntokens++;
-                *e = '\0';
-                if (ntokens == max_tokens - 1) {
-                    e++;
-                    s = e; /* so we don't add an extra token */
-                    break;
-                }
             }
-            s = e + 1;
+            /* scanned the whole string: terminal value pointer is null */
+            tokens[ntokens].value = NULL;
+            tokens[ntokens].length = 0;
+            return ++ntokens;
         }
-        e++;
-    }
 
-    if (s != e) {
         tokens[ntokens].value = s;
         tokens[ntokens].length = e - s;
         ntokens++;
+        *e = '\0';
+        e++;
+        if (ntokens == max_tokens - 1) {
+            /* out of tokens: terminal value is the first unprocessed char */
+            tokens[ntokens].value = *e == '\0' ? NULL : e;
+            tokens[ntokens].length = 0;
+            return ++ntokens;
+        }
+        s = e;
     }
-
-    /*
-     * If we scanned the whole string, the terminal value pointer is null,
-     * otherwise it is the first unprocessed character.
-     */
-    tokens[ntokens].value =  *e == '\0' ? NULL : e;
-    tokens[ntokens].length = 0;
-    ntokens++;
-
-    return ntokens;
 }
 
 int try_read_command_asciiauth(conn *c) {
@@ -369,7 +461,7 @@ int try_read_command_asciiauth(conn *c) {
 
         // final token is a NULL ender, so we have one more than expected.
         if (ntokens < 6
-                || strcmp(tokens[0].value, "set") != 0
+                || !CMD_EQ(&tokens[0], "set")
                 || !safe_strtoul(tokens[4].value, &size)) {
             if (!c->resp) {
                 if (!resp_start(c)) {
@@ -410,7 +502,7 @@ int try_read_command_asciiauth(conn *c) {
     // must end with \r\n
     // NB: I thought ASCII sets also worked with just \n, but according to
     // complete_nread_ascii only \r\n is valid.
-    if (strncmp(cont + c->rlbytes - 2, "\r\n", 2) != 0) {
+    if (!ends_crlf(cont + c->rlbytes - 2)) {
         out_string(c, "CLIENT_ERROR bad command line termination");
         return 1;
     }
@@ -448,7 +540,13 @@ int try_read_command_ascii(conn *c) {
     if (c->rbytes == 0)
         return 0;
 
-    el = memchr(c->rcurr, '\n', c->rbytes);
+    /* short buffers (the common single command) scan faster word-at-a-time;
+     * leave big pipelined/multiget buffers to the wider memchr. */
+    if (c->rbytes <= 128) {
+        el = scan_lf(c->rcurr, c->rbytes);
+    } else {
+        el = memchr(c->rcurr, '\n', c->rbytes);
+    }
     if (!el) {
         if (c->rbytes > 2048) {
             /*
@@ -512,7 +610,7 @@ static inline bool set_noreply_maybe(conn *c, token_t *tokens, size_t ntokens)
       it can't be helped.
     */
     if (tokens[noreply_index].value
-        && strcmp(tokens[noreply_index].value, "noreply") == 0) {
+        && CMD_EQ(&tokens[noreply_index], "noreply")) {
         c->noreply = true;
     }
     return c->noreply;
@@ -543,6 +641,93 @@ static inline int make_ascii_get_suffix(char *suffix, item *it, bool return_cas,
     return (p - suffix) + 2;
 }
 
+/* Specialized single-key get/gets path. The vast majority of get traffic is
+ * one key per command; this skips the multi-key loop, key_token advancement
+ * and the re-tokenization check entirely. */
+static void process_get_one(conn *c, const char *key, const size_t nkey, bool return_cas) {
+    item *it;
+    bool overflow; // not used here.
+    mc_resp *resp = c->resp;
+
+    if (nkey > KEY_MAX_LENGTH) {
+        out_string(c, "CLIENT_ERROR bad command line format");
+        return;
+    }
+
+    it = limited_get(key, nkey, c->thread, 0, false, DO_UPDATE, &overflow);
+    if (unlikely(settings.detail_enabled)) {
+        stats_prefix_record_get(key, nkey, NULL != it);
+    }
+    if (it) {
+        MEMCACHED_COMMAND_GET(c->sfd, ITEM_key(it), it->nkey,
+                              it->nbytes, ITEM_get_cas(it));
+        /* start the payload towards L1 while the header is built */
+        __builtin_prefetch(ITEM_data(it), 0, 0);
+        char *p = resp->wbuf;
+        memcpy(p, "VALUE ", 6);
+        p += 6;
+        memcpy(p, ITEM_key(it), it->nkey);
+        p += it->nkey;
+        p += make_ascii_get_suffix(p, it, return_cas, it->nbytes);
+        resp_add_iov(resp, resp->wbuf, p - resp->wbuf);
+
+#ifdef EXTSTORE
+        if (it->it_flags & ITEM_HDR) {
+            if (storage_get_item(c, it, resp) != 0) {
+                THR_STATS_BUMP(c->thread, get_oom_extstore);
+
+                item_remove(it);
+                conn_release_items(c);
+                if (!resp_start(c)) {
+                    conn_set_state(c, conn_closing);
+                    return;
+                }
+                out_of_memory(c, "SERVER_ERROR out of memory writing get response");
+                return;
+            }
+        } else if ((it->it_flags & ITEM_CHUNKED) == 0) {
+            resp_add_iov(resp, ITEM_data(it), it->nbytes);
+        } else {
+            resp_add_chunked_iov(resp, it, it->nbytes);
+        }
+#else
+        if ((it->it_flags & ITEM_CHUNKED) == 0) {
+            resp_add_iov(resp, ITEM_data(it), it->nbytes);
+        } else {
+            resp_add_chunked_iov(resp, it, it->nbytes);
+        }
+#endif
+
+        if (unlikely(settings.verbose > 1)) {
+            fprintf(stderr, ">%d sending key ", c->sfd);
+            if (fwrite(key, 1, it->nkey, stderr)) {}
+            fputc('\n', stderr);
+        }
+
+        /* item_get() has incremented it->refcount for us */
+        THR_STATS_BUMP(c->thread, lru_hits[it->slabs_clsid]);
+        THR_STATS_BUMP(c->thread, get_cmds);
+#ifdef EXTSTORE
+        /* If ITEM_HDR, an io_wrap owns the reference. */
+        if ((it->it_flags & ITEM_HDR) == 0) {
+            resp->item = it;
+        }
+#else
+        resp->item = it;
+#endif
+    } else {
+        THR_STATS_BUMP(c->thread, get_misses);
+        THR_STATS_BUMP(c->thread, get_cmds);
+        MEMCACHED_COMMAND_GET(c->sfd, key, nkey, -1, 0);
+    }
+
+    if (unlikely(settings.verbose > 1))
+        fprintf(stderr, ">%d END\n", c->sfd);
+
+    resp_add_iov(resp, "END\r\n", 5);
+    conn_set_state(c, conn_new_cmd);
+}
+
 /* ntokens is overwritten here... shrug.. */
 static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens, bool return_cas, bool should_touch) {
     char *key;
@@ -555,9 +740,15 @@ static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens,
     assert(c != NULL);
     mc_resp *resp = c->resp;
 
+    /* get/gets with exactly one key take the specialized path. */
+    if (ntokens == 3 && !should_touch) {
+        process_get_one(c, tokens[KEY_TOKEN].value, tokens[KEY_TOKEN].length, return_cas);
+        return;
+    }
+
     if (should_touch) {
         // For get and touch commands, use first token as exptime
-        if (!safe_strtol(tokens[1].value, &exptime_int)) {
+        if (!safe_strtol_len(tokens[1].value, tokens[1].length, &exptime_int)) {
             out_string(c, "CLIENT_ERROR invalid exptime argument");
             return;
         }
@@ -576,8 +767,14 @@ static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens,
                 goto stop;
             }
 
+            /* Overlap the next key's bucket fetch with this key's lookup
+             * and response assembly. */
+            if (key_token[1].length != 0 && key_token[1].length <= KEY_MAX_LENGTH) {
+                assoc_prefetch(hash(key_token[1].value, key_token[1].length));
+            }
+
             it = limited_get(key, nkey, c->thread, exptime, should_touch, DO_UPDATE, &overflow);
-            if (settings.detail_enabled) {
+            if (unlikely(settings.detail_enabled)) {
                 stats_prefix_record_get(key, nkey, NULL != it);
             }
             if (it) {
@@ -592,6 +789,8 @@ static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens,
                 {
                   MEMCACHED_COMMAND_GET(c->sfd, ITEM_key(it), it->nkey,
                                         it->nbytes, ITEM_get_cas(it));
+                  /* start the payload towards L1 while the header is built */
+                  __builtin_prefetch(ITEM_data(it), 0, 0);
                   int nbytes = it->nbytes;
                   char *p = resp->wbuf;
                   memcpy(p, "VALUE ", 6);
@@ -604,9 +803,7 @@ static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens,
 #ifdef EXTSTORE
                   if (it->it_flags & ITEM_HDR) {
                       if (storage_get_item(c, it, resp) != 0) {
-                          pthread_mutex_lock(&c->thread->stats.mutex);
-                          c->thread->stats.get_oom_extstore++;
-                          pthread_mutex_unlock(&c->thread->stats.mutex);
+                          THR_STATS_BUMP(c->thread, get_oom_extstore);
 
                           item_remove(it);
                           goto stop;
@@ -625,25 +822,20 @@ static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens,
 #endif
                 }
 
-                if (settings.verbose > 1) {
-                    int ii;
+                if (unlikely(settings.verbose > 1)) {
                     fprintf(stderr, ">%d sending key ", c->sfd);
-                    for (ii = 0; ii < it->nkey; ++ii) {
-                        fprintf(stderr, "%c", key[ii]);
-                    }
-                    fprintf(stderr, "\n");
+                    if (fwrite(key, 1, it->nkey, stderr)) {}
+                    fputc('\n', stderr);
                 }
 
                 /* item_get() has incremented it->refcount for us */
-                pthread_mutex_lock(&c->thread->stats.mutex);
                 if (should_touch) {
-                    c->thread->stats.touch_cmds++;
-                    c->thread->stats.slab_stats[ITEM_clsid(it)].touch_hits++;
+                    THR_STATS_BUMP(c->thread, touch_cmds);
+                    THR_STATS_BUMP(c->thread, slab_stats[ITEM_clsid(it)].touch_hits);
                 } else {
-                    c->thread->stats.lru_hits[it->slabs_clsid]++;
-                    c->thread->stats.get_cmds++;
+                    THR_STATS_BUMP(c->thread, lru_hits[it->slabs_clsid]);
+                    THR_STATS_BUMP(c->thread, get_cmds);
                 }
-                pthread_mutex_unlock(&c->thread->stats.mutex);
 #ifdef EXTSTORE
                 /* If ITEM_HDR, an io_wrap owns the reference. */
                 if ((it->it_flags & ITEM_HDR) == 0) {
@@ -653,16 +845,14 @@ static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens,
                 resp->item = it;
 #endif
             } else {
-                pthread_mutex_lock(&c->thread->stats.mutex);
                 if (should_touch) {
-                    c->thread->stats.touch_cmds++;
-                    c->thread->stats.touch_misses++;
+                    THR_STATS_BUMP(c->thread, touch_cmds);
+                    THR_STATS_BUMP(c->thread, touch_misses);
                 } else {
-                    c->thread->stats.get_misses++;
-                    c->thread->stats.get_cmds++;
+                    THR_STATS_BUMP(c->thread, get_misses);
+                    THR_STATS_BUMP(c->thread, get_cmds);
                 }
                 MEMCACHED_COMMAND_GET(c->sfd, key, nkey, -1, 0);
-                pthread_mutex_unlock(&c->thread->stats.mutex);
             }
 
             key_token++;
@@ -689,7 +879,7 @@ static inline void process_get_command(conn *c, token_t *tokens, size_t ntokens,
     } while(key_token->value != NULL);
 stop:
 
-    if (settings.verbose > 1)
+    if (unlikely(settings.verbose > 1))
         fprintf(stderr, ">%d END\n", c->sfd);
 
     /*
@@ -718,18 +908,18 @@ stop:
     }
 }
 
-inline static void process_stats_detail(conn *c, const char *command) {
+static COLD_FUNC void process_stats_detail(conn *c, const token_t *command) {
     assert(c != NULL);
 
-    if (strcmp(command, "on") == 0) {
+    if (command != NULL && CMD_EQ(command, "on")) {
         settings.detail_enabled = 1;
         out_string(c, "OK");
     }
-    else if (strcmp(command, "off") == 0) {
+    else if (command != NULL && CMD_EQ(command, "off")) {
         settings.detail_enabled = 0;
         out_string(c, "OK");
     }
-    else if (strcmp(command, "dump") == 0) {
+    else if (command != NULL && CMD_EQ(command, "dump")) {
         int len;
         char *stats = stats_prefix_dump(&len);
         write_and_free(c, stats, len);
@@ -739,7 +929,7 @@ inline static void process_stats_detail(conn *c, const char *command) {
     }
 }
 
-static void process_stat(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_stat(conn *c, token_t *tokens, const size_t ntokens) {
     const char *subcommand = tokens[SUBCOMMAND_TOKEN].value;
     assert(c != NULL);
 
@@ -751,11 +941,11 @@ static void process_stat(conn *c, token_t *tokens, const size_t ntokens) {
     if (ntokens == 2) {
         server_stats(&append_stats, c);
         (void)get_stats(NULL, 0, &append_stats, c);
-    } else if (strcmp(subcommand, "reset") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "reset")) {
         stats_reset();
         out_string(c, "RESET");
         return;
-    } else if (strcmp(subcommand, "detail") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "detail")) {
         if (!settings.dump_enabled) {
             out_string(c, "CLIENT_ERROR stats detail not allowed");
             return;
@@ -763,14 +953,14 @@ static void process_stat(conn *c, token_t *tokens, const size_t ntokens) {
 
         /* NOTE: how to tackle detail with binary? */
         if (ntokens < 4)
-            process_stats_detail(c, "");  /* outputs the error message */
+            process_stats_detail(c, NULL);  /* outputs the error message */
         else
-            process_stats_detail(c, tokens[2].value);
+            process_stats_detail(c, &tokens[2]);
         /* Output already generated */
         return;
-    } else if (strcmp(subcommand, "settings") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "settings")) {
         process_stat_settings(&append_stats, c);
-    } else if (strcmp(subcommand, "cachedump") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "cachedump")) {
         char *buf;
         unsigned int bytes, id, limit = 0;
 
@@ -798,18 +988,18 @@ static void process_stat(conn *c, token_t *tokens, const size_t ntokens) {
         buf = item_cachedump(id, limit, &bytes);
         write_and_free(c, buf, bytes);
         return;
-    } else if (strcmp(subcommand, "conns") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "conns")) {
         process_stats_conns(&append_stats, c);
 #ifdef EXTSTORE
-    } else if (strcmp(subcommand, "extstore") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "extstore")) {
         process_extstore_stats(&append_stats, c);
 #endif
 #ifdef PROXY
-    } else if (strcmp(subcommand, "proxy") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "proxy")) {
         process_proxy_stats(settings.proxy_ctx, &append_stats, c);
-    } else if (strcmp(subcommand, "proxyfuncs") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "proxyfuncs")) {
         process_proxy_funcstats(settings.proxy_ctx, &append_stats, c);
-    } else if (strcmp(subcommand, "proxybe") == 0) {
+    } else if (CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "proxybe")) {
         process_proxy_bestats(settings.proxy_ctx, &append_stats, c);
 #endif
     } else {
@@ -819,8 +1009,7 @@ static void process_stat(conn *c, token_t *tokens, const size_t ntokens) {
             if (c->stats.buffer == NULL) {
                 out_of_memory(c, "SERVER_ERROR out of memory writing stats");
             } else {
-                write_and_free(c, c->stats.buffer, c->stats.offset);
-                c->stats.buffer = NULL;
+                write_stats_buf(c);
             }
         } else {
             out_string(c, "ERROR");
@@ -834,8 +1023,7 @@ static void process_stat(conn *c, token_t *tokens, const size_t ntokens) {
     if (c->stats.buffer == NULL) {
         out_of_memory(c, "SERVER_ERROR out of memory writing stats");
     } else {
-        write_and_free(c, c->stats.buffer, c->stats.offset);
-        c->stats.buffer = NULL;
+        write_stats_buf(c);
     }
 }
 
@@ -968,7 +1156,7 @@ static int _meta_flag_preparse(token_t *tokens, const size_t start,
             case 'N':
                 of->locked = 1;
                 of->vivify = 1;
-                if (!safe_strtol(tokens[i].value+1, &tmp_int)) {
+                if (!safe_strtol_len(tokens[i].value+1, tokens[i].length-1, &tmp_int)) {
                     *errstr = "CLIENT_ERROR bad token in command line format";
                     of->has_error = 1;
                 } else {
@@ -977,7 +1165,7 @@ static int _meta_flag_preparse(token_t *tokens, const size_t start,
                 break;
             case 'T':
                 of->locked = 1;
-                if (!safe_strtol(tokens[i].value+1, &tmp_int)) {
+                if (!safe_strtol_len(tokens[i].value+1, tokens[i].length-1, &tmp_int)) {
                     *errstr = "CLIENT_ERROR bad token in command line format";
                     of->has_error = 1;
                 } else {
@@ -987,7 +1175,7 @@ static int _meta_flag_preparse(token_t *tokens, const size_t start,
                 break;
             case 'R':
                 of->locked = 1;
-                if (!safe_strtol(tokens[i].value+1, &tmp_int)) {
+                if (!safe_strtol_len(tokens[i].value+1, tokens[i].length-1, &tmp_int)) {
                     *errstr = "CLIENT_ERROR bad token in command line format";
                     of->has_error = 1;
                 } else {
@@ -1025,12 +1213,12 @@ static int _meta_flag_preparse(token_t *tokens, const size_t start,
                 break;
             // mset-related.
             case 'F':
-                if (!safe_strtoflags(tokens[i].value+1, &of->client_flags)) {
+                if (!safe_strtoflags_len(tokens[i].value+1, tokens[i].length-1, &of->client_flags)) {
                     of->has_error = true;
                 }
                 break;
             case 'C': // mset, mdelete, marithmetic
-                if (!safe_strtoull(tokens[i].value+1, &of->req_cas_id)) {
+                if (!safe_strtoull_len(tokens[i].value+1, tokens[i].length-1, &of->req_cas_id)) {
                     *errstr = "CLIENT_ERROR bad token in command line format";
                     of->has_error = true;
                 } else {
@@ -1038,7 +1226,7 @@ static int _meta_flag_preparse(token_t *tokens, const size_t start,
                 }
                 break;
             case 'E': // ms, md, ma
-                if (!safe_strtoull(tokens[i].value+1, &of->cas_id_in)) {
+                if (!safe_strtoull_len(tokens[i].value+1, tokens[i].length-1, &of->cas_id_in)) {
                     *errstr = "CLIENT_ERROR bad token in command line format";
                     of->has_error = true;
                 } else {
@@ -1054,13 +1242,13 @@ static int _meta_flag_preparse(token_t *tokens, const size_t start,
                 }
                 break;
             case 'J': // marithmetic initial value
-                if (!safe_strtoull(tokens[i].value+1, &of->initial)) {
+                if (!safe_strtoull_len(tokens[i].value+1, tokens[i].length-1, &of->initial)) {
                     *errstr = "CLIENT_ERROR invalid numeric initial value";
                     of->has_error = 1;
                 }
                 break;
             case 'D': // marithmetic delta value
-                if (!safe_strtoull(tokens[i].value+1, &of->delta)) {
+                if (!safe_strtoull_len(tokens[i].value+1, tokens[i].length-1, &of->delta)) {
                     *errstr = "CLIENT_ERROR invalid numeric delta value";
                     of->has_error = 1;
                 }
@@ -1434,7 +1622,7 @@ static void process_mset_command(conn *c, token_t *tokens, const size_t ntokens)
     // final buffer in complete_nread_ascii.
     p = resp->wbuf;
 
-    if (!safe_strtol(tokens[KEY_TOKEN + 1].value, (int32_t*)&vlen)) {
+    if (!safe_strtol_len(tokens[KEY_TOKEN + 1].value, tokens[KEY_TOKEN + 1].length, (int32_t*)&vlen)) {
         out_errstring(c, "CLIENT_ERROR bad command line format");
         return;
     }
@@ -1832,11 +2020,12 @@ static void process_marithmetic_command(conn *c, token_t *tokens, const size_t n
     item_lock(hv);
     locked = true;
     char tmpbuf[INCR_MAX_STORAGE_LEN];
+    size_t vlen = 0;
 
     // return a referenced item if it exists, so we can modify it here, rather
     // than adding even more parameters to do_add_delta.
     bool item_created = false;
-    switch(do_add_delta(c->thread, key, nkey, incr, of.delta, tmpbuf, &of.req_cas_id, hv, &it)) {
+    switch(do_add_delta(c->thread, key, nkey, incr, of.delta, tmpbuf, &vlen, &of.req_cas_id, hv, &it)) {
     case OK:
         if (c->noreply)
             resp->skip = true;
@@ -1857,8 +2046,7 @@ static void process_marithmetic_command(conn *c, token_t *tokens, const size_t n
         break;
     case DELTA_ITEM_NOT_FOUND:
         if (of.vivify) {
-            itoa_u64(of.initial, tmpbuf);
-            int vlen = strlen(tmpbuf);
+            vlen = itoa_u64(of.initial, tmpbuf) - tmpbuf;
 
             it = item_alloc(key, nkey, 0, 0, vlen+2);
             if (it != NULL) {
@@ -1899,7 +2087,6 @@ static void process_marithmetic_command(conn *c, token_t *tokens, const size_t n
     // allows building the response with information after vivifying from a
     // miss, or returning a new CAS value after add_delta().
     if (it) {
-        size_t vlen = strlen(tmpbuf);
         if (of.value) {
             memcpy(p, "VA ", 3);
             p = itoa_u32(vlen, p+3);
@@ -2017,9 +2204,9 @@ static void process_update_command(conn *c, token_t *tokens, const size_t ntoken
     key = tokens[KEY_TOKEN].value;
     nkey = tokens[KEY_TOKEN].length;
 
-    if (! (safe_strtoflags(tokens[2].value, &flags)
-           && safe_strtol(tokens[3].value, &exptime_int)
-           && safe_strtol(tokens[4].value, (int32_t *)&vlen))) {
+    if (! (safe_strtoflags_len(tokens[2].value, tokens[2].length, &flags)
+           && safe_strtol_len(tokens[3].value, tokens[3].length, &exptime_int)
+           && safe_strtol_len(tokens[4].value, tokens[4].length, (int32_t *)&vlen))) {
         out_string(c, "CLIENT_ERROR bad command line format");
         return;
     }
@@ -2028,7 +2215,7 @@ static void process_update_command(conn *c, token_t *tokens, const size_t ntoken
 
     // does cas value exist?
     if (handle_cas) {
-        if (!safe_strtoull(tokens[5].value, &req_cas_id)) {
+        if (!safe_strtoull_len(tokens[5].value, tokens[5].length, &req_cas_id)) {
             out_string(c, "CLIENT_ERROR bad command line format");
             return;
         }
@@ -2040,7 +2227,7 @@ static void process_update_command(conn *c, token_t *tokens, const size_t ntoken
     }
     vlen += 2;
 
-    if (settings.detail_enabled) {
+    if (unlikely(settings.detail_enabled)) {
         stats_prefix_record_set(key, nkey);
     }
 
@@ -2116,7 +2303,7 @@ static void process_touch_command(conn *c, token_t *tokens, const size_t ntokens
     key = tokens[KEY_TOKEN].value;
     nkey = tokens[KEY_TOKEN].length;
 
-    if (!safe_strtol(tokens[2].value, &exptime_int)) {
+    if (!safe_strtol_len(tokens[2].value, tokens[2].length, &exptime_int)) {
         out_string(c, "CLIENT_ERROR invalid exptime argument");
         return;
     }
@@ -2129,7 +2316,7 @@ static void process_touch_command(conn *c, token_t *tokens, const size_t ntokens
         c->thread->stats.slab_stats[ITEM_clsid(it)].touch_hits++;
         pthread_mutex_unlock(&c->thread->stats.mutex);
 
-        out_string(c, "TOUCHED");
+        out_lstring(c, "TOUCHED");
         item_remove(it);
     } else {
         pthread_mutex_lock(&c->thread->stats.mutex);
@@ -2137,12 +2324,13 @@ static void process_touch_command(conn *c, token_t *tokens, const size_t ntokens
         c->thread->stats.touch_misses++;
         pthread_mutex_unlock(&c->thread->stats.mutex);
 
-        out_string(c, "NOT_FOUND");
+        out_lstring(c, "NOT_FOUND");
     }
 }
 
 static void process_arithmetic_command(conn *c, token_t *tokens, const size_t ntokens, const bool incr) {
     char temp[INCR_MAX_STORAGE_LEN];
+    size_t templen = 0;
     uint64_t delta;
     char *key;
     size_t nkey;
@@ -2159,14 +2347,14 @@ static void process_arithmetic_command(conn *c, token_t *tokens, const size_t nt
     key = tokens[KEY_TOKEN].value;
     nkey = tokens[KEY_TOKEN].length;
 
-    if (!safe_strtoull(tokens[2].value, &delta)) {
+    if (!safe_strtoull_len(tokens[2].value, tokens[2].length, &delta)) {
         out_string(c, "CLIENT_ERROR invalid numeric delta argument");
         return;
     }
 
-    switch(add_delta(c->thread, key, nkey, incr, delta, temp, NULL)) {
+    switch(add_delta(c->thread, key, nkey, incr, delta, temp, &templen, NULL)) {
     case OK:
-        out_string(c, temp);
+        out_string_len(c, temp, templen);
         break;
     case NON_NUMERIC:
         out_string(c, "CLIENT_ERROR cannot increment or decrement non-numeric value");
@@ -2200,7 +2388,7 @@ static void process_delete_command(conn *c, token_t *tokens, const size_t ntoken
     assert(c != NULL);
 
     if (ntokens > 3) {
-        bool hold_is_zero = strcmp(tokens[KEY_TOKEN+1].value, "0") == 0;
+        bool hold_is_zero = CMD_EQ(&tokens[KEY_TOKEN+1], "0");
         bool sets_noreply = set_noreply_maybe(c, tokens, ntokens);
         bool valid = (ntokens == 4 && (hold_is_zero || sets_noreply))
             || (ntokens == 5 && hold_is_zero && sets_noreply);
@@ -2220,7 +2408,7 @@ static void process_delete_command(conn *c, token_t *tokens, const size_t ntoken
         return;
     }
 
-    if (settings.detail_enabled) {
+    if (unlikely(settings.detail_enabled)) {
         stats_prefix_record_delete(key, nkey);
     }
 
@@ -2235,18 +2423,18 @@ static void process_delete_command(conn *c, token_t *tokens, const size_t ntoken
         do_item_unlink(it, hv);
         STORAGE_delete(c->thread->storage, it);
         do_item_remove(it);      /* release our reference */
-        out_string(c, "DELETED");
+        out_lstring(c, "DELETED");
     } else {
         pthread_mutex_lock(&c->thread->stats.mutex);
         c->thread->stats.delete_misses++;
         pthread_mutex_unlock(&c->thread->stats.mutex);
 
-        out_string(c, "NOT_FOUND");
+        out_lstring(c, "NOT_FOUND");
     }
     item_unlock(hv);
 }
 
-static void process_verbosity_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_verbosity_command(conn *c, token_t *tokens, const size_t ntokens) {
     unsigned int level;
 
     assert(c != NULL);
@@ -2263,7 +2451,7 @@ static void process_verbosity_command(conn *c, token_t *tokens, const size_t nto
 }
 
 #ifdef MEMCACHED_DEBUG
-static void process_misbehave_command(conn *c) {
+static COLD_FUNC void process_misbehave_command(conn *c) {
     int allowed = 0;
 
     // try opening new TCP socket
@@ -2286,12 +2474,12 @@ static void process_misbehave_command(conn *c) {
     }
 }
 
-static void process_debugtime_command(conn *c, token_t *tokens, const size_t ntokens) {
-    if (strcmp(tokens[1].value, "p") == 0) {
+static COLD_FUNC void process_debugtime_command(conn *c, token_t *tokens, const size_t ntokens) {
+    if (CMD_EQ(&tokens[1], "p")) {
         if (!is_paused) {
             is_paused = true;
         }
-    } else if (strcmp(tokens[1].value, "r") == 0) {
+    } else if (CMD_EQ(&tokens[1], "r")) {
         if (is_paused) {
             is_paused = false;
         }
@@ -2307,21 +2495,21 @@ static void process_debugtime_command(conn *c, token_t *tokens, const size_t nto
     out_string(c, "OK");
 }
 
-static void process_debugitem_command(conn *c, token_t *tokens, const size_t ntokens) {
-    if (strcmp(tokens[1].value, "lock") == 0) {
+static COLD_FUNC void process_debugitem_command(conn *c, token_t *tokens, const size_t ntokens) {
+    if (CMD_EQ(&tokens[1], "lock")) {
         uint32_t hv = hash(tokens[2].value, tokens[2].length);
         item_lock(hv);
-    } else if (strcmp(tokens[1].value, "unlock") == 0) {
+    } else if (CMD_EQ(&tokens[1], "unlock")) {
         uint32_t hv = hash(tokens[2].value, tokens[2].length);
         item_unlock(hv);
-    } else if (strcmp(tokens[1].value, "ref") == 0) {
+    } else if (CMD_EQ(&tokens[1], "ref")) {
         // intentionally leak a reference.
         item *it = item_get(tokens[2].value, tokens[2].length, c->thread, DONT_UPDATE);
         if (it == NULL) {
             out_string(c, "MISS");
             return;
         }
-    } else if (strcmp(tokens[1].value, "unref") == 0) {
+    } else if (CMD_EQ(&tokens[1], "unref")) {
         // double unlink. debugger must have already ref'ed it or this
         // underflows.
         item *it = item_get(tokens[2].value, tokens[2].length, c->thread, DONT_UPDATE);
@@ -2339,7 +2527,7 @@ static void process_debugitem_command(conn *c, token_t *tokens, const size_t nto
 }
 #endif
 
-static void process_slabs_automove_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_slabs_automove_command(conn *c, token_t *tokens, const size_t ntokens) {
     unsigned int level;
     double ratio;
 
@@ -2347,7 +2535,7 @@ static void process_slabs_automove_command(conn *c, token_t *tokens, const size_
 
     set_noreply_maybe(c, tokens, ntokens);
 
-    if (strcmp(tokens[2].value, "ratio") == 0) {
+    if (CMD_EQ(&tokens[2], "ratio")) {
         if (ntokens < 5 || !safe_strtod(tokens[3].value, &ratio)) {
             out_string(c, "ERROR");
             return;
@@ -2355,14 +2543,14 @@ static void process_slabs_automove_command(conn *c, token_t *tokens, const size_
         // TODO: settings needs an overhaul... no locks/etc.
         settings.slab_automove_ratio = ratio;
         settings.slab_automove_version++;
-    } else if (strcmp(tokens[2].value, "freeratio") == 0) {
+    } else if (CMD_EQ(&tokens[2], "freeratio")) {
         if (ntokens < 5 || !safe_strtod(tokens[3].value, &ratio)) {
             out_string(c, "ERROR");
             return;
         }
         settings.slab_automove_freeratio = ratio;
         settings.slab_automove_version++;
-    } else if (strcmp(tokens[2].value, "window") == 0) {
+    } else if (CMD_EQ(&tokens[2], "window")) {
         if (ntokens < 5 || !safe_strtoul(tokens[3].value, (uint32_t*)&level)) {
             out_string(c, "CLIENT_ERROR bad command line format");
             return;
@@ -2389,7 +2577,7 @@ static void process_slabs_automove_command(conn *c, token_t *tokens, const size_
 }
 
 /* TODO: decide on syntax for sampling? */
-static void process_watch_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_watch_command(conn *c, token_t *tokens, const size_t ntokens) {
     uint16_t f = 0;
     int x;
     assert(c != NULL);
@@ -2407,25 +2595,25 @@ static void process_watch_command(conn *c, token_t *tokens, const size_t ntokens
 
     if (ntokens > 2) {
         for (x = COMMAND_TOKEN + 1; x < ntokens - 1; x++) {
-            if ((strcmp(tokens[x].value, "rawcmds") == 0)) {
+            if ((CMD_EQ(&tokens[x], "rawcmds"))) {
                 f |= LOG_RAWCMDS;
-            } else if ((strcmp(tokens[x].value, "evictions") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "evictions"))) {
                 f |= LOG_EVICTIONS;
-            } else if ((strcmp(tokens[x].value, "fetchers") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "fetchers"))) {
                 f |= LOG_FETCHERS;
-            } else if ((strcmp(tokens[x].value, "mutations") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "mutations"))) {
                 f |= LOG_MUTATIONS;
-            } else if ((strcmp(tokens[x].value, "sysevents") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "sysevents"))) {
                 f |= LOG_SYSEVENTS;
-            } else if ((strcmp(tokens[x].value, "connevents") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "connevents"))) {
                 f |= LOG_CONNEVENTS;
-            } else if ((strcmp(tokens[x].value, "proxyreqs") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "proxyreqs"))) {
                 f |= LOG_PROXYREQS;
-            } else if ((strcmp(tokens[x].value, "proxyevents") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "proxyevents"))) {
                 f |= LOG_PROXYEVENTS;
-            } else if ((strcmp(tokens[x].value, "proxyuser") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "proxyuser"))) {
                 f |= LOG_PROXYUSER;
-            } else if ((strcmp(tokens[x].value, "deletions") == 0)) {
+            } else if ((CMD_EQ(&tokens[x], "deletions"))) {
                 f |= LOG_DELETIONS;
             } else {
                 out_string(c, "ERROR");
@@ -2450,7 +2638,7 @@ static void process_watch_command(conn *c, token_t *tokens, const size_t ntokens
     }
 }
 
-static void process_memlimit_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_memlimit_command(conn *c, token_t *tokens, const size_t ntokens) {
     uint32_t memlimit;
     assert(c != NULL);
 
@@ -2477,7 +2665,7 @@ static void process_memlimit_command(conn *c, token_t *tokens, const size_t ntok
     }
 }
 
-static void process_lru_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_lru_command(conn *c, token_t *tokens, const size_t ntokens) {
     uint32_t pct_hot;
     uint32_t pct_warm;
     double hot_factor;
@@ -2486,7 +2674,7 @@ static void process_lru_command(conn *c, token_t *tokens, const size_t ntokens)
 
     set_noreply_maybe(c, tokens, ntokens);
 
-    if (strcmp(tokens[1].value, "tune") == 0 && ntokens >= 7) {
+    if (CMD_EQ(&tokens[1], "tune") && ntokens >= 7) {
         if (!safe_strtoul(tokens[2].value, &pct_hot) ||
             !safe_strtoul(tokens[3].value, &pct_warm) ||
             !safe_strtod(tokens[4].value, &hot_factor) ||
@@ -2505,18 +2693,18 @@ static void process_lru_command(conn *c, token_t *tokens, const size_t ntokens)
                 out_string(c, "OK");
             }
         }
-    } else if (strcmp(tokens[1].value, "mode") == 0 && ntokens >= 4 &&
+    } else if (CMD_EQ(&tokens[1], "mode") && ntokens >= 4 &&
                settings.lru_maintainer_thread) {
-        if (strcmp(tokens[2].value, "flat") == 0) {
+        if (CMD_EQ(&tokens[2], "flat")) {
             settings.lru_segmented = false;
             out_string(c, "OK");
-        } else if (strcmp(tokens[2].value, "segmented") == 0) {
+        } else if (CMD_EQ(&tokens[2], "segmented")) {
             settings.lru_segmented = true;
             out_string(c, "OK");
         } else {
             out_string(c, "ERROR");
         }
-    } else if (strcmp(tokens[1].value, "temp_ttl") == 0 && ntokens >= 4 &&
+    } else if (CMD_EQ(&tokens[1], "temp_ttl") && ntokens >= 4 &&
                settings.lru_maintainer_thread) {
         if (!safe_strtol(tokens[2].value, &ttl)) {
             out_string(c, "ERROR");
@@ -2534,12 +2722,12 @@ static void process_lru_command(conn *c, token_t *tokens, const size_t ntokens)
     }
 }
 #ifdef EXTSTORE
-static void process_extstore_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_extstore_command(conn *c, token_t *tokens, const size_t ntokens) {
     set_noreply_maybe(c, tokens, ntokens);
     bool ok = true;
     if (ntokens < 4) {
         ok = false;
-    } else if (strcmp(tokens[1].value, "free_memchunks") == 0 && ntokens > 4) {
+    } else if (CMD_EQ(&tokens[1], "free_memchunks") && ntokens > 4) {
         // setting is deprecated and ignored, but accepted for backcompat
         unsigned int clsid = 0;
         unsigned int limit = 0;
@@ -2553,34 +2741,34 @@ static void process_extstore_command(conn *c, token_t *tokens, const size_t ntok
                 ok = false;
             }
         }
-    } else if (strcmp(tokens[1].value, "item_size") == 0) {
+    } else if (CMD_EQ(&tokens[1], "item_size")) {
         if (safe_strtoul(tokens[2].value, &settings.ext_item_size)) {
             settings.slab_automove_version++;
         } else {
             ok = false;
         }
-    } else if (strcmp(tokens[1].value, "item_age") == 0) {
+    } else if (CMD_EQ(&tokens[1], "item_age")) {
         if (!safe_strtoul(tokens[2].value, &settings.ext_item_age))
             ok = false;
-    } else if (strcmp(tokens[1].value, "low_ttl") == 0) {
+    } else if (CMD_EQ(&tokens[1], "low_ttl")) {
         if (!safe_strtoul(tokens[2].value, &settings.ext_low_ttl))
             ok = false;
-    } else if (strcmp(tokens[1].value, "recache_rate") == 0) {
+    } else if (CMD_EQ(&tokens[1], "recache_rate")) {
         if (!safe_strtoul(tokens[2].value, &settings.ext_recache_rate))
             ok = false;
-    } else if (strcmp(tokens[1].value, "compact_under") == 0) {
+    } else if (CMD_EQ(&tokens[1], "compact_under")) {
         if (!safe_strtoul(tokens[2].value, &settings.ext_compact_under))
             ok = false;
-    } else if (strcmp(tokens[1].value, "drop_under") == 0) {
+    } else if (CMD_EQ(&tokens[1], "drop_under")) {
         if (!safe_strtoul(tokens[2].value, &settings.ext_drop_under))
             ok = false;
-    } else if (strcmp(tokens[1].value, "max_sleep") == 0) {
+    } else if (CMD_EQ(&tokens[1], "max_sleep")) {
         if (!safe_strtoul(tokens[2].value, &settings.ext_max_sleep))
             ok = false;
-    } else if (strcmp(tokens[1].value, "max_frag") == 0) {
+    } else if (CMD_EQ(&tokens[1], "max_frag")) {
         if (!safe_strtod(tokens[2].value, &settings.ext_max_frag))
             ok = false;
-    } else if (strcmp(tokens[1].value, "drop_unread") == 0) {
+    } else if (CMD_EQ(&tokens[1], "drop_unread")) {
         unsigned int v;
         if (!safe_strtoul(tokens[2].value, &v)) {
             ok = false;
@@ -2597,7 +2785,7 @@ static void process_extstore_command(conn *c, token_t *tokens, const size_t ntok
     }
 }
 #endif
-static void process_flush_all_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_flush_all_command(conn *c, token_t *tokens, const size_t ntokens) {
     int32_t exptime = 0;
     rel_time_t new_oldest = 0;
 
@@ -2637,17 +2825,17 @@ static void process_flush_all_command(conn *c, token_t *tokens, const size_t nto
     out_string(c, "OK");
 }
 
-static void process_version_command(conn *c) {
+static COLD_FUNC void process_version_command(conn *c) {
     out_string(c, "VERSION " VERSION);
 }
 
-static void process_quit_command(conn *c) {
+static COLD_FUNC void process_quit_command(conn *c) {
     conn_set_state(c, conn_mwrite);
     c->close_after_write = true;
     c->close_reason = NORMAL_CLOSE;
 }
 
-static void process_shutdown_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_shutdown_command(conn *c, token_t *tokens, const size_t ntokens) {
     if (!settings.shutdown_command) {
         out_string(c, "ERROR: shutdown not enabled");
         return;
@@ -2657,7 +2845,7 @@ static void process_shutdown_command(conn *c, token_t *tokens, const size_t ntok
         c->close_reason = SHUTDOWN_CLOSE;
         conn_set_state(c, conn_closing);
         raise(SIGINT);
-    } else if (ntokens == 3 && strcmp(tokens[SUBCOMMAND_TOKEN].value, "graceful") == 0) {
+    } else if (ntokens == 3 && CMD_EQ(&tokens[SUBCOMMAND_TOKEN], "graceful")) {
         c->close_reason = SHUTDOWN_CLOSE;
         conn_set_state(c, conn_closing);
         raise(SIGUSR1);
@@ -2666,8 +2854,8 @@ static void process_shutdown_command(conn *c, token_t *tokens, const size_t ntok
     }
 }
 
-static void process_slabs_command(conn *c, token_t *tokens, const size_t ntokens) {
-    if (ntokens == 5 && strcmp(tokens[COMMAND_TOKEN + 1].value, "reassign") == 0) {
+static COLD_FUNC void process_slabs_command(conn *c, token_t *tokens, const size_t ntokens) {
+    if (ntokens == 5 && CMD_EQ(&tokens[COMMAND_TOKEN + 1], "reassign")) {
         int src, dst, rv;
 
         if (settings.slab_reassign == false) {
@@ -2701,15 +2889,15 @@ static void process_slabs_command(conn *c, token_t *tokens, const size_t ntokens
         }
         return;
     } else if (ntokens >= 4 &&
-        (strcmp(tokens[COMMAND_TOKEN + 1].value, "automove") == 0)) {
+        (CMD_EQ(&tokens[COMMAND_TOKEN + 1], "automove"))) {
         process_slabs_automove_command(c, tokens, ntokens);
     } else {
         out_string(c, "ERROR");
     }
 }
 
-static void process_lru_crawler_command(conn *c, token_t *tokens, const size_t ntokens) {
-    if (ntokens == 4 && strcmp(tokens[COMMAND_TOKEN + 1].value, "crawl") == 0) {
+static COLD_FUNC void process_lru_crawler_command(conn *c, token_t *tokens, const size_t ntokens) {
+    if (ntokens == 4 && CMD_EQ(&tokens[COMMAND_TOKEN + 1], "crawl")) {
         int rv;
         if (settings.lru_crawler == false) {
             out_string(c, "CLIENT_ERROR lru crawler disabled");
@@ -2736,7 +2924,7 @@ static void process_lru_crawler_command(conn *c, token_t *tokens, const size_t n
             break;
         }
         return;
-    } else if (ntokens == 4 && strcmp(tokens[COMMAND_TOKEN + 1].value, "metadump") == 0) {
+    } else if (ntokens == 4 && CMD_EQ(&tokens[COMMAND_TOKEN + 1], "metadump")) {
         if (settings.lru_crawler == false) {
             out_string(c, "CLIENT_ERROR lru crawler disabled");
             return;
@@ -2777,7 +2965,7 @@ static void process_lru_crawler_command(conn *c, token_t *tokens, const size_t n
                 break;
         }
         return;
-    } else if (ntokens == 4 && strcmp(tokens[COMMAND_TOKEN + 1].value, "mgdump") == 0) {
+    } else if (ntokens == 4 && CMD_EQ(&tokens[COMMAND_TOKEN + 1], "mgdump")) {
         if (settings.lru_crawler == false) {
             out_string(c, "CLIENT_ERROR lru crawler disabled");
             return;
@@ -2812,7 +3000,7 @@ static void process_lru_crawler_command(conn *c, token_t *tokens, const size_t n
                 break;
         }
         return;
-    } else if (ntokens == 4 && strcmp(tokens[COMMAND_TOKEN + 1].value, "tocrawl") == 0) {
+    } else if (ntokens == 4 && CMD_EQ(&tokens[COMMAND_TOKEN + 1], "tocrawl")) {
         uint32_t tocrawl;
          if (!safe_strtoul(tokens[2].value, &tocrawl)) {
             out_string(c, "CLIENT_ERROR bad command line format");
@@ -2821,7 +3009,7 @@ static void process_lru_crawler_command(conn *c, token_t *tokens, const size_t n
         settings.lru_crawler_tocrawl = tocrawl;
         out_string(c, "OK");
         return;
-    } else if (ntokens == 4 && strcmp(tokens[COMMAND_TOKEN + 1].value, "sleep") == 0) {
+    } else if (ntokens == 4 && CMD_EQ(&tokens[COMMAND_TOKEN + 1], "sleep")) {
         uint32_t tosleep;
         if (!safe_strtoul(tokens[2].value, &tosleep)) {
             out_string(c, "CLIENT_ERROR bad command line format");
@@ -2835,13 +3023,13 @@ static void process_lru_crawler_command(conn *c, token_t *tokens, const size_t n
         out_string(c, "OK");
         return;
     } else if (ntokens == 3) {
-        if ((strcmp(tokens[COMMAND_TOKEN + 1].value, "enable") == 0)) {
+        if ((CMD_EQ(&tokens[COMMAND_TOKEN + 1], "enable"))) {
             if (start_item_crawler_thread() == 0) {
                 out_string(c, "OK");
             } else {
                 out_string(c, "ERROR failed to start lru crawler thread");
             }
-        } else if ((strcmp(tokens[COMMAND_TOKEN + 1].value, "disable") == 0)) {
+        } else if ((CMD_EQ(&tokens[COMMAND_TOKEN + 1], "disable"))) {
             if (stop_item_crawler_thread(CRAWLER_NOWAIT) == 0) {
                 out_string(c, "OK");
             } else {
@@ -2856,7 +3044,7 @@ static void process_lru_crawler_command(conn *c, token_t *tokens, const size_t n
     }
 }
 #ifdef TLS
-static void process_refresh_certs_command(conn *c, token_t *tokens, const size_t ntokens) {
+static COLD_FUNC void process_refresh_certs_command(conn *c, token_t *tokens, const size_t ntokens) {
     set_noreply_maybe(c, tokens, ntokens);
     char *errmsg = NULL;
     if (refresh_certs(&errmsg)) {
@@ -2876,6 +3064,7 @@ static void process_refresh_certs_command(conn *c, token_t *tokens, const size_t
 // we can't drop out and back in again.
 // Leaving this note here to spend more time on a fix when necessary, or if an
 // opportunity becomes obvious.
+
 void process_command_ascii(conn *c, char *command) {
 
     token_t tokens[MAX_TOKENS];
@@ -2886,7 +3075,7 @@ void process_command_ascii(conn *c, char *command) {
 
     MEMCACHED_PROCESS_COMMAND_START(c->sfd, c->rcurr, c->rbytes);
 
-    if (settings.verbose > 1)
+    if (unlikely(settings.verbose > 1))
         fprintf(stderr, "<%d %s\n", c->sfd, command);
 
     /*
@@ -2901,6 +3090,31 @@ void process_command_ascii(conn *c, char *command) {
     }
 
     c->thread->cur_sfd = c->sfd; // cuddle sfd for logging.
+
+    // Most traffic is a single-key get/gets; recognize the verb from the
+    // leading bytes and hand the key straight to the specialized path
+    // without running the tokenizer. Any second key (or trailing space)
+    // falls through to the general dispatch below.
+    if (command[0] == 'g' && command[1] == 'e' && command[2] == 't') {
+        bool return_cas = false;
+        const char *key = NULL;
+        if (command[3] == ' ') {
+            key = command + 4;
+        } else if (command[3] == 's' && command[4] == ' ') {
+            key = command + 5;
+            return_cas = true;
+        }
+        if (key != NULL && *key != '\0' && *key != ' ') {
+            const char *end = key + 1;
+            while (*end != '\0' && *end != ' ')
+                end++;
+            if (*end == '\0') {
+                process_get_one(c, key, end - key, return_cas);
+                return;
+            }
+        }
+    }
+
     ntokens = tokenize_command(command, tokens, MAX_TOKENS);
     // All commands need a minimum of two tokens: cmd and NULL finalizer
     // There are also no valid commands shorter than two bytes.
@@ -2909,187 +3123,244 @@ void process_command_ascii(conn *c, char *command) {
         return;
     }
 
-    // Meta commands are all 2-char in length.
+    // Dispatch on the first command byte; the compiler turns this into a
+    // jump table so each command family gets its own predicted target.
     char first = tokens[COMMAND_TOKEN].value[0];
-    if (first == 'm' && tokens[COMMAND_TOKEN].length == 2) {
-        switch (tokens[COMMAND_TOKEN].value[1]) {
-            case 'g':
-                process_mget_command(c, tokens, ntokens);
-                break;
-            case 's':
-                process_mset_command(c, tokens, ntokens);
-                break;
-            case 'd':
-                process_mdelete_command(c, tokens, ntokens);
-                break;
-            case 'n':
-                out_string(c, "MN");
-                // mn command forces immediate writeback flush.
-                conn_set_state(c, conn_mwrite);
-                break;
-            case 'a':
-                process_marithmetic_command(c, tokens, ntokens);
-                break;
-            case 'e':
-                process_meta_command(c, tokens, ntokens);
-                break;
-            default:
-                out_string(c, "ERROR");
-                break;
+    switch (first) {
+    case 'm':
+        // Meta commands are all 2-char in length.
+        if (tokens[COMMAND_TOKEN].length == 2) {
+            switch (tokens[COMMAND_TOKEN].value[1]) {
+                case 'g':
+                    process_mget_command(c, tokens, ntokens);
+                    break;
+                case 's':
+                    process_mset_command(c, tokens, ntokens);
+                    break;
+                case 'd':
+                    process_mdelete_command(c, tokens, ntokens);
+                    break;
+                case 'n':
+                    out_string(c, "MN");
+                    // mn command forces immediate writeback flush.
+                    conn_set_state(c, conn_mwrite);
+                    break;
+                case 'a':
+                    process_marithmetic_command(c, tokens, ntokens);
+                    break;
+                case 'e':
+                    process_meta_command(c, tokens, ntokens);
+                    break;
+                default:
+                    out_string(c, "ERROR");
+                    break;
+            }
+#ifdef MEMCACHED_DEBUG
+        // commands which exist only for testing the memcached's security protection
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "misbehave")) {
+            process_misbehave_command(c);
+#endif
+        } else {
+            goto maybe_http;
         }
-    } else if (first == 'g') {
+        break;
+    case 'g':
         // Various get commands are very common.
         WANT_TOKENS_MIN(ntokens, 3);
-        if (strcmp(tokens[COMMAND_TOKEN].value, "get") == 0) {
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "get")) {
 
             process_get_command(c, tokens, ntokens, false, false);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "gets") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "gets")) {
 
             process_get_command(c, tokens, ntokens, true, false);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "gat") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "gat")) {
 
             process_get_command(c, tokens, ntokens, false, true);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "gats") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "gats")) {
 
             process_get_command(c, tokens, ntokens, true, true);
         } else {
             out_string(c, "ERROR");
         }
-    } else if (first == 's') {
-        if (strcmp(tokens[COMMAND_TOKEN].value, "set") == 0 && (comm = NREAD_SET)) {
+        break;
+    case 's':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "set") && (comm = NREAD_SET)) {
 
             WANT_TOKENS_OR(ntokens, 6, 7);
             process_update_command(c, tokens, ntokens, comm, false);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "stats") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "stats")) {
 
             process_stat(c, tokens, ntokens);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "shutdown") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "shutdown")) {
 
             process_shutdown_command(c, tokens, ntokens);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "slabs") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "slabs")) {
 
             process_slabs_command(c, tokens, ntokens);
         } else {
             out_string(c, "ERROR");
         }
-    } else if (first == 'a') {
-        if ((strcmp(tokens[COMMAND_TOKEN].value, "add") == 0 && (comm = NREAD_ADD)) ||
-            (strcmp(tokens[COMMAND_TOKEN].value, "append") == 0 && (comm = NREAD_APPEND)) ) {
+        break;
+    case 'a':
+        if ((CMD_EQ(&tokens[COMMAND_TOKEN], "add") && (comm = NREAD_ADD)) ||
+            (CMD_EQ(&tokens[COMMAND_TOKEN], "append") && (comm = NREAD_APPEND)) ) {
 
             WANT_TOKENS_OR(ntokens, 6, 7);
             process_update_command(c, tokens, ntokens, comm, false);
         } else {
             out_string(c, "ERROR");
         }
-    } else if (first == 'c') {
-        if (strcmp(tokens[COMMAND_TOKEN].value, "cas") == 0 && (comm = NREAD_CAS)) {
+        break;
+    case 'c':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "cas") && (comm = NREAD_CAS)) {
 
             WANT_TOKENS_OR(ntokens, 7, 8);
             process_update_command(c, tokens, ntokens, comm, true);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "cache_memlimit") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "cache_memlimit")) {
 
             WANT_TOKENS_OR(ntokens, 3, 4);
             process_memlimit_command(c, tokens, ntokens);
         } else {
             out_string(c, "ERROR");
         }
-    } else if (first == 'i') {
-        if (strcmp(tokens[COMMAND_TOKEN].value, "incr") == 0) {
+        break;
+    case 'i':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "incr")) {
 
             WANT_TOKENS_OR(ntokens, 4, 5);
             process_arithmetic_command(c, tokens, ntokens, 1);
         } else {
             out_string(c, "ERROR");
         }
-    } else if (first == 'd') {
-        if (strcmp(tokens[COMMAND_TOKEN].value, "delete") == 0) {
+        break;
+    case 'd':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "delete")) {
 
             WANT_TOKENS(ntokens, 3, 5);
             process_delete_command(c, tokens, ntokens);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "decr") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "decr")) {
 
             WANT_TOKENS_OR(ntokens, 4, 5);
             process_arithmetic_command(c, tokens, ntokens, 0);
 #ifdef MEMCACHED_DEBUG
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "debugtime") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "debugtime")) {
             WANT_TOKENS_MIN(ntokens, 2);
             process_debugtime_command(c, tokens, ntokens);
-        } else if (strcmp(tokens[COMMAND_TOKEN].value, "debugitem") == 0) {
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "debugitem")) {
             WANT_TOKENS_MIN(ntokens, 2);
             process_debugitem_command(c, tokens, ntokens);
 #endif
         } else {
             out_string(c, "ERROR");
         }
-    } else if (first == 't') {
-        if (strcmp(tokens[COMMAND_TOKEN].value, "touch") == 0) {
+        break;
+    case 't':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "touch")) {
 
             WANT_TOKENS_OR(ntokens, 4, 5);
             process_touch_command(c, tokens, ntokens);
         } else {
             out_string(c, "ERROR");
         }
-    } else if (
-                (strcmp(tokens[COMMAND_TOKEN].value, "replace") == 0 && (comm = NREAD_REPLACE)) ||
-                (strcmp(tokens[COMMAND_TOKEN].value, "prepend") == 0 && (comm = NREAD_PREPEND)) ) {
-
-        WANT_TOKENS_OR(ntokens, 6, 7);
-        process_update_command(c, tokens, ntokens, comm, false);
-
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "bget") == 0) {
-        // ancient "binary get" command which isn't in any documentation, was
-        // removed > 10 years ago, etc. Keeping for compatibility reasons but
-        // we should look deeper into client code and remove this.
-        WANT_TOKENS_MIN(ntokens, 3);
-        process_get_command(c, tokens, ntokens, false, false);
-
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "flush_all") == 0) {
-
-        WANT_TOKENS(ntokens, 2, 4);
-        process_flush_all_command(c, tokens, ntokens);
-
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "version") == 0) {
-
-        process_version_command(c);
+        break;
+    case 'r':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "replace") && (comm = NREAD_REPLACE)) {
 
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "quit") == 0) {
+            WANT_TOKENS_OR(ntokens, 6, 7);
+            process_update_command(c, tokens, ntokens, comm, false);
+#ifdef TLS
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "refresh_certs")) {
+            process_refresh_certs_command(c, tokens, ntokens);
+#endif
+        } else {
+            goto maybe_http;
+        }
+        break;
+    case 'p':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "prepend") && (comm = NREAD_PREPEND)) {
 
-        process_quit_command(c);
+            WANT_TOKENS_OR(ntokens, 6, 7);
+            process_update_command(c, tokens, ntokens, comm, false);
+        } else {
+            goto maybe_http;
+        }
+        break;
+    case 'b':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "bget")) {
+            // ancient "binary get" command which isn't in any documentation, was
+            // removed > 10 years ago, etc. Keeping for compatibility reasons but
+            // we should look deeper into client code and remove this.
+            WANT_TOKENS_MIN(ntokens, 3);
+            process_get_command(c, tokens, ntokens, false, false);
+        } else {
+            goto maybe_http;
+        }
+        break;
+    case 'f':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "flush_all")) {
 
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "lru_crawler") == 0) {
+            WANT_TOKENS(ntokens, 2, 4);
+            process_flush_all_command(c, tokens, ntokens);
+        } else {
+            goto maybe_http;
+        }
+        break;
+    case 'v':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "version")) {
 
-        process_lru_crawler_command(c, tokens, ntokens);
+            process_version_command(c);
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "verbosity")) {
+            WANT_TOKENS_OR(ntokens, 3, 4);
+            process_verbosity_command(c, tokens, ntokens);
+        } else {
+            goto maybe_http;
+        }
+        break;
+    case 'q':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "quit")) {
 
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "watch") == 0) {
+            process_quit_command(c);
+        } else {
+            goto maybe_http;
+        }
+        break;
+    case 'l':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "lru_crawler")) {
 
-        process_watch_command(c, tokens, ntokens);
+            process_lru_crawler_command(c, tokens, ntokens);
+        } else if (CMD_EQ(&tokens[COMMAND_TOKEN], "lru")) {
+            WANT_TOKENS_MIN(ntokens, 3);
+            process_lru_command(c, tokens, ntokens);
+        } else {
+            goto maybe_http;
+        }
+        break;
+    case 'w':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "watch")) {
 
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "verbosity") == 0) {
-        WANT_TOKENS_OR(ntokens, 3, 4);
-        process_verbosity_command(c, tokens, ntokens);
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "lru") == 0) {
-        WANT_TOKENS_MIN(ntokens, 3);
-        process_lru_command(c, tokens, ntokens);
-#ifdef MEMCACHED_DEBUG
-    // commands which exist only for testing the memcached's security protection
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "misbehave") == 0) {
-        process_misbehave_command(c);
-#endif
+            process_watch_command(c, tokens, ntokens);
+        } else {
+            goto maybe_http;
+        }
+        break;
 #ifdef EXTSTORE
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "extstore") == 0) {
-        WANT_TOKENS_MIN(ntokens, 3);
-        process_extstore_command(c, tokens, ntokens);
-#endif
-#ifdef TLS
-    } else if (strcmp(tokens[COMMAND_TOKEN].value, "refresh_certs") == 0) {
-        process_refresh_certs_command(c, tokens, ntokens);
+    case 'e':
+        if (CMD_EQ(&tokens[COMMAND_TOKEN], "extstore")) {
+            WANT_TOKENS_MIN(ntokens, 3);
+            process_extstore_command(c, tokens, ntokens);
+        } else {
+            goto maybe_http;
+        }
+        break;
 #endif
-    } else {
+    default:
+    maybe_http:
         if (strncmp(tokens[ntokens - 2].value, "HTTP/", 5) == 0) {
             conn_set_state(c, conn_closing);
         } else {
             out_string(c, "ERROR");
         }
+        break;
     }
     return;
 }
@@ -97,21 +97,25 @@ static void * alloc_large_chunk(const size_t limit)
     void *ptr = NULL;
 #if defined(__linux__) && defined(MADV_HUGEPAGE)
     size_t pagesize = 0;
+    size_t hp_free = 0;
     FILE *fp;
     int ret;
 
-    /* Get the size of huge pages */
+    /* Get the size of huge pages and how many are actually reserved. */
     fp = fopen("/proc/meminfo", "r");
     if (fp != NULL) {
         char buf[64];
 
-        while ((fgets(buf, sizeof(buf), fp)))
+        while ((fgets(buf, sizeof(buf), fp))) {
             if (!strncmp(buf, "Hugepagesize:", 13)) {
                 ret = sscanf(buf + 13, "%zu\n", &pagesize);
 
                 /* meminfo huge page size is in KiBs */
                 pagesize <<= 10;
+            } else if (!strncmp(buf, "HugePages_Free:", 15)) {
+                ret = sscanf(buf + 15, "%zu\n", &hp_free);
             }
+        }
         fclose(fp);
     }
 
@@ -123,6 +127,45 @@ static void * alloc_large_chunk(const size_t limit)
     if (settings.verbose > 1)
         fprintf(stderr, "huge page size: %zu\n", pagesize);
 
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_1GB)
+    /* Very large pools benefit from 1GB pages where the kernel has any
+     * reserved; these come from their own pool so just attempt the map
+     * and fall through on failure. */
+    if (limit >= ((size_t)4 << 30)) {
+        const size_t gpage = (size_t)1 << 30;
+        size_t glimit = (limit + gpage - 1) & ~(gpage - 1);
+        ptr = mmap(NULL, glimit, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB,
+                   -1, 0);
+        if (ptr != MAP_FAILED) {
+            if (settings.verbose > 1)
+                fprintf(stderr, "using explicit 1GB huge page mapping\n");
+            return ptr;
+        }
+        ptr = NULL;
+    }
+#endif
+#ifdef MAP_HUGETLB
+    /* Try explicitly reserved huge pages next: unlike the transparent
+     * hint below, the mapping is guaranteed huge-backed for its lifetime
+     * and can't be split under memory pressure. Needs pages reserved via
+     * vm.nr_hugepages; quietly fall through to the hint when too few
+     * are free to cover the pool. */
+    {
+        size_t hlimit = (limit + pagesize - 1) & ~(pagesize - 1);
+        if (hlimit / pagesize <= hp_free) {
+            ptr = mmap(NULL, hlimit, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (ptr != MAP_FAILED) {
+                if (settings.verbose > 1)
+                    fprintf(stderr, "using explicit huge page mapping\n");
+                return ptr;
+            }
+            ptr = NULL;
+        }
+    }
+#endif
+
     /* This works because glibc simply uses mmap when the alignment is
      * above a certain limit. */
     ret = posix_memalign(&ptr, pagesize, limit);
@@ -66,19 +66,25 @@ struct conn_queue {
 pthread_mutex_t lru_locks[POWER_LARGEST];
 
 /* Connection lock around accepting new connections */
-pthread_mutex_t conn_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t conn_lock CACHELINE_ALIGNED = PTHREAD_MUTEX_INITIALIZER;
 
 #if !defined(HAVE_GCC_ATOMICS) && !defined(__sun)
 pthread_mutex_t atomics_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
 /* Lock for global stats */
-static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t stats_lock CACHELINE_ALIGNED = PTHREAD_MUTEX_INITIALIZER;
 
 /* Lock to cause worker threads to hang up after being woken */
 static pthread_mutex_t worker_hang_lock;
 
-static pthread_mutex_t *item_locks;
+/* Bucket locks are padded out to a cache line each so two cores hammering
+ * neighbouring hash buckets don't bounce the same line between them. */
+typedef struct {
+    pthread_mutex_t mutex;
+} CACHELINE_ALIGNED item_lock_t;
+
+static item_lock_t *item_locks;
 /* size of the item lock hash table */
 static uint32_t item_lock_count;
 static unsigned int item_lock_hashpower;
@@ -115,11 +121,11 @@ static void thread_libevent_ionotify(evutil_socket_t fd, short which, void *arg)
  */
 
 void item_lock(uint32_t hv) {
-    mutex_lock(&item_locks[hv & hashmask(item_lock_hashpower)]);
+    mutex_lock(&item_locks[hv & hashmask(item_lock_hashpower)].mutex);
 }
 
 void *item_trylock(uint32_t hv) {
-    pthread_mutex_t *lock = &item_locks[hv & hashmask(item_lock_hashpower)];
+    pthread_mutex_t *lock = &item_locks[hv & hashmask(item_lock_hashpower)].mutex;
     if (pthread_mutex_trylock(lock) == 0) {
         return lock;
     }
@@ -131,7 +137,7 @@ void item_trylock_unlock(void *lock) {
 }
 
 void item_unlock(uint32_t hv) {
-    mutex_unlock(&item_locks[hv & hashmask(item_lock_hashpower)]);
+    mutex_unlock(&item_locks[hv & hashmask(item_lock_hashpower)].mutex);
 }
 
 static void wait_for_thread_registration(int nthreads) {
@@ -945,13 +951,13 @@ void item_unlink(item *item) {
 enum delta_result_type add_delta(LIBEVENT_THREAD *t, const char *key,
                                  const size_t nkey, bool incr,
                                  const int64_t delta, char *buf,
-                                 uint64_t *cas) {
+                                 size_t *len_out, uint64_t *cas) {
     enum delta_result_type ret;
     uint32_t hv;
 
     hv = hash(key, nkey);
     item_lock(hv);
-    ret = do_add_delta(t, key, nkey, incr, delta, buf, cas, hv, NULL);
+    ret = do_add_delta(t, key, nkey, incr, delta, buf, len_out, cas, hv, NULL);
     item_unlock(hv);
     return ret;
 }
@@ -1117,13 +1123,13 @@ void memcached_thread_init(int nthreads, void *arg) {
     item_lock_count = hashsize(power);
     item_lock_hashpower = power;
 
-    item_locks = calloc(item_lock_count, sizeof(pthread_mutex_t));
+    item_locks = calloc(item_lock_count, sizeof(item_lock_t));
     if (! item_locks) {
         perror("Can't allocate item locks");
         exit(1);
     }
     for (i = 0; i < item_lock_count; i++) {
-        pthread_mutex_init(&item_locks[i], NULL);
+        pthread_mutex_init(&item_locks[i].mutex, NULL);
     }
 
     threads = calloc(nthreads, sizeof(LIBEVENT_THREAD));
@@ -1149,6 +1155,24 @@ void memcached_thread_init(int nthreads, void *arg) {
         create_worker(worker_libevent, &threads[i]);
     }
 
+#ifdef __linux__
+    /* Opt-in: pin workers round-robin onto CPUs so each stays on one
+     * core's caches instead of migrating under scheduler pressure. */
+    if (settings.worker_cpu_affinity) {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+        for (i = 0; ncpus > 0 && i < nthreads; i++) {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(i % ncpus, &cpuset);
+            if (pthread_setaffinity_np(threads[i].thread_id,
+                                       sizeof(cpu_set_t), &cpuset) != 0) {
+                fprintf(stderr, "Warning: failed to set worker thread affinity\n");
+                break;
+            }
+        }
+    }
+#endif
+
     /* Wait for all the threads to set themselves up before returning. */
     pthread_mutex_lock(&init_lock);
     wait_for_thread_registration(nthreads);
@@ -239,6 +239,10 @@ void vperror(const char *fmt, ...) {
 #ifndef HAVE_HTONLL
 static uint64_t mc_swap64(uint64_t in) {
 #ifdef ENDIAN_LITTLE
+#if defined(__GNUC__) || defined(__clang__)
+    /* single BSWAP instruction on x86; similar on other arches. */
+    return __builtin_bswap64(in);
+#else
     /* Little endian, flip the bytes around until someone makes a faster/better
     * way to do this. */
     int64_t rv = 0;
@@ -248,6 +252,7 @@ static uint64_t mc_swap64(uint64_t in) {
         in >>= 8;
      }
     return rv;
+#endif
 #else
     /* big-endian machines don't need byte swapping */
     return in;
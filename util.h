@@ -22,6 +22,75 @@ bool safe_strtod(const char *str, double *out);
 bool safe_strcpy(char *dst, const char *src, const size_t dstmax);
 bool safe_memcmp(const void *a, const void *b, size_t len);
 
+/*
+ * Length-aware fast paths for parsing protocol tokens. The overwhelmingly
+ * common case is a short run of plain digits, which these convert with a
+ * tight loop; anything else (signs, whitespace, overlong or near-overflow
+ * input) falls back to the full safe_* parsers so semantics are unchanged.
+ * Digit counts are capped so the fast paths cannot overflow their types.
+ */
+static inline bool safe_strtoul_len(const char *str, size_t len, uint32_t *out) {
+    if (len > 0 && len <= 9) {
+        uint32_t v = 0;
+        size_t i;
+        for (i = 0; i < len; i++) {
+            unsigned d = (unsigned)str[i] - '0';
+            if (d > 9)
+                break;
+            v = v * 10 + d;
+        }
+        if (i == len) {
+            *out = v;
+            return true;
+        }
+    }
+    return safe_strtoul(str, out);
+}
+
+static inline bool safe_strtol_len(const char *str, size_t len, int32_t *out) {
+    const char *p = str;
+    size_t n = len;
+    bool neg = false;
+    if (n > 1 && *p == '-') {
+        neg = true;
+        p++;
+        n--;
+    }
+    if (n > 0 && n <= 9) {
+        int32_t v = 0;
+        size_t i;
+        for (i = 0; i < n; i++) {
+            unsigned d = (unsigned)p[i] - '0';
+            if (d > 9)
+                break;
+            v = v * 10 + d;
+        }
+        if (i == n) {
+            *out = neg ? -v : v;
+            return true;
+        }
+    }
+    return safe_strtol(str, out);
+}
+
+static inline bool safe_strtoull_len(const char *str, size_t len, uint64_t *out) {
+    if (len > 0 && len <= 19) {
+        uint64_t v = 0;
+        size_t i;
+        for (i = 0; i < len; i++) {
+            unsigned d = (unsigned)str[i] - '0';
+            if (d > 9)
+                break;
+            v = v * 10 + d;
+        }
+        if (i == len) {
+            *out = v;
+            return true;
+        }
+    }
+    return safe_strtoull(str, out);
+}
+
 #ifndef HAVE_HTONLL
 extern uint64_t htonll(uint64_t);
 extern uint64_t ntohll(uint64_t);